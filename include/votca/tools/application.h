@@ -23,6 +23,8 @@
 
 namespace votca { namespace tools {
 
+class ThreadPool;
+
 class Application
 {
 public:
@@ -36,6 +38,16 @@ public:
      * \return return code
      */
     int Exec(int argc, char **argv);
+    /**
+     * \brief executes the program with a pool of worker threads
+     * \param argc argc from main
+     * \param argv argv from main
+     * \return return code, 130 if the run was interrupted
+     *
+     * Like Exec, but adds the --nthreads option, starts a ThreadPool and
+     * calls RunThreaded instead of Run. On SIGINT pending jobs are
+     * discarded, running jobs are finished and OnInterrupt is called.
+     */
     int ExecThreaded(int argc, char **argv);
 
     /**
@@ -93,8 +105,37 @@ public:
      * the work should be done in here.
      */
     virtual void Run() { }
+    /**
+     * \brief Main body of a threaded application
+     *
+     * Called by ExecThreaded, submit the work as jobs to Pool(). Jobs
+     * still running after RunThreaded returns are waited for.
+     */
     virtual void RunThreaded() { }
 
+    /**
+     * \brief called after the run was interrupted by SIGINT
+     *
+     * All jobs have stopped when this is called, overload it to write
+     * out partial results.
+     */
+    virtual void OnInterrupt() { }
+
+    /**
+     * \brief reset per-job state in batch mode
+     *
+     * With --batch or --socket several jobs are run by one process, this is
+     * called after each job. Overload it to clear results of the previous
+     * job, caches (e.g. PropertyCache, TableCache) should be kept.
+     */
+    virtual void ResetJob() { }
+
+    /// true once SIGINT was received during ExecThreaded
+    static bool Interrupted();
+
+    /// worker pool, only valid during RunThreaded
+    ThreadPool &Pool();
+
     /**
      * \brief add option for command line
      * \param group group string
@@ -159,8 +200,26 @@ protected:
     bool _continue_execution;
     
 private:
+    /// combine the option groups, called once before parsing
+    void SetupOptions();
     /// get input parameters from file, location may be specified in command line
     void ParseCommandLine(int argc, char **argv);
+
+    /// common part of Exec and ExecThreaded
+    int Execute(int argc, char **argv, bool threaded);
+    /// evaluate the parsed options and run
+    int RunJob(bool threaded);
+    int RunWithPool();
+
+    /// batch mode, each line is the command line of a job
+    int RunBatch(std::istream &in, bool threaded);
+    int RunBatchJob(const string &line, bool threaded);
+    /// path is copied, the jobs replace the parsed options it comes from
+    int RunSocket(const string path, bool threaded);
+    /// accepts clients on a listening socket until one sends shutdown
+    void ServeSocket(int server, bool threaded);
+
+    ThreadPool *_pool;
     
     /// program options without the Hidden group
     boost::program_options::options_description _visible_options;
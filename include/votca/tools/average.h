@@ -18,9 +18,20 @@
 #ifndef _AVERAGE_H
 #define	_AVERAGE_H
 
+#include <cmath>
+#include <cstddef>
+
 namespace votca { namespace tools {
 
-// do not use this calss yet!
+/**
+    \brief running average with variance and higher moments
+
+    The moments are updated with Welford's algorithm, sums of deviations
+    from the current mean are accumulated instead of raw powers, which avoids
+    the cancellation of the textbook formula. Averages of several threads
+    can be combined with merge, the result is the same as if all values
+    had been processed by one Average.
+*/
 template<typename T>
 class Average
 {
@@ -30,20 +41,36 @@ public:
     
     void Process(const T &v);
     void Clear();
+    /**
+        process a range of values, the values are processed in blocks
+        which are merged into the running moments
+     */
     template<typename iterator_type>
     void ProcessRange(const iterator_type &begin, const iterator_type   &end);
+    /// combine with the average of another set of values
+    void merge(const Average<T> &other);
     
+    /// standard deviation (with n-1 normalization)
     T CalcDev();
+    /// variance (with n normalization)
     T CalcSig2();
+    /// skewness of the distribution
+    T CalcSkewness();
+    /// excess kurtosis of the distribution
+    T CalcKurtosis();
     const T &getAvg();
+    /// second raw moment <x^2>
     const T getM2();
     size_t getN();
     
 private:
-    
+    void merge(size_t n, const T &av, const T &m2, const T &m3, const T &m4);
+
     size_t _n;
     T _av; // average
-    T _m2; // second moment
+    T _m2; // sum of squared deviations from the average
+    T _m3; // sum of cubed deviations
+    T _m4; // sum of 4th powers of deviations
 };
 
 template<typename T>
@@ -52,14 +79,22 @@ Average<T>::Average()
 
 template <>
 inline Average<double>::Average()
-: _n(0), _av(0), _m2(0) {}
+: _n(0), _av(0), _m2(0), _m3(0), _m4(0) {}
 
 template<typename T>
 inline void Average<T>::Process(const T &value)
 { 
-   _av = _av*(double)_n/(double)(_n+1) + value / (double)(_n+1);
-   _n++;
-   _m2 += value*value;   
+    double n1 = _n;
+    _n++;
+    double n = _n;
+    T delta = value - _av;
+    T delta_n = delta / n;
+    T delta_n2 = delta_n*delta_n;
+    T term1 = delta*delta_n*n1;
+    _av += delta_n;
+    _m4 += term1*delta_n2*(n*n - 3*n + 3) + 6*delta_n2*_m2 - 4*delta_n*_m3;
+    _m3 += term1*delta_n*(n - 2) - 3*delta_n*_m2;
+    _m2 += term1;
 }
 
 template<typename T>
@@ -67,38 +102,86 @@ inline void Average<T>::Clear()
 {
    _av = 0;
    _n = 0;
-   _m2 = 0 ;
+   _m2 = 0;
+   _m3 = 0;
+   _m4 = 0;
 }
 
-/*
-template<>
-inline void Average<double>::Process(const double &value)
-{
-    _av = _av*(double)_n/(double)(_n+1) + value / (double)(_n+1);
-    _n++;
-    _m2 += value*value;
-}
-*/
 template<typename T>
 template<typename iterator_type>
 void Average<T>::ProcessRange(const iterator_type &begin, const iterator_type   &end){ 
-    for(iterator_type iter=begin; iter!=end; ++iter){
-        Process(*iter);
+    // the moments of each block are calculated with two simple loops
+    // without divisions (which the compiler can vectorize) and then merged
+    const size_t block = 256;
+    T buf[block];
+    iterator_type iter=begin;
+    while(iter != end) {
+        size_t n = 0;
+        for(; n<block && iter!=end; ++iter, ++n)
+            buf[n] = *iter;
+
+        T sum = 0;
+        for(size_t i=0; i<n; ++i)
+            sum += buf[i];
+        T av = sum/(double)n;
+
+        T m2 = 0, m3 = 0, m4 = 0;
+        for(size_t i=0; i<n; ++i) {
+            T d = buf[i] - av;
+            T d2 = d*d;
+            m2 += d2;
+            m3 += d2*d;
+            m4 += d2*d2;
+        }
+        merge(n, av, m2, m3, m4);
+    }
+}
+
+template<typename T>
+void Average<T>::merge(const Average<T> &other)
+{
+    merge(other._n, other._av, other._m2, other._m3, other._m4);
+}
+
+template<typename T>
+void Average<T>::merge(size_t nb_, const T &av, const T &m2, const T &m3, const T &m4)
+{
+    if(nb_ == 0) return;
+    if(_n == 0) {
+        _n = nb_; _av = av; _m2 = m2; _m3 = m3; _m4 = m4;
+        return;
     }
+    double na = _n, nb = nb_;
+    double n = na + nb;
+    T delta = av - _av;
+    T delta2 = delta*delta;
+
+    _m4 += m4 + delta2*delta2*na*nb*(na*na - na*nb + nb*nb)/(n*n*n)
+        + 6*delta2*(na*na*m2 + nb*nb*_m2)/(n*n) + 4*delta*(na*m3 - nb*_m3)/n;
+    _m3 += m3 + delta2*delta*na*nb*(na - nb)/(n*n) + 3*delta*(na*m2 - nb*_m2)/n;
+    _m2 += m2 + delta2*na*nb/n;
+    _av += delta*nb/n;
+    _n += nb_;
 }
 
 template<typename T>
 T Average<T>::CalcDev(){
-    double dev = 0.0;
-    dev = sqrt((_m2-_n*_av*_av)/(_n-1));
-    return dev;
+    return sqrt(_m2/(_n-1));
 }
 
 template<typename T>
 T Average<T>::CalcSig2(){
-    double dev = 0.0;
-    dev = _m2/_n-_av*_av ;
-    return dev;
+    return _m2/_n;
+}
+
+template<typename T>
+T Average<T>::CalcSkewness(){
+    return sqrt((double)_n)*_m3/pow(_m2, 1.5);
+}
+
+template<typename T>
+T Average<T>::CalcKurtosis(){
+    return _n*_m4/(_m2*_m2) - 3.0;
 }
 
 template<typename T>
@@ -108,9 +191,7 @@ const T &Average<T>::getAvg(){
 
 template<typename T>
 const T Average<T>::getM2(){
-    double m2 = 0.0;
-    m2 = _m2/_n;
-    return m2;
+    return _m2/_n + _av*_av;
 }
 
 template<typename T>
@@ -121,4 +202,3 @@ size_t Average<T>::getN(){
 }}
 
 #endif	/* _AVERAGE_H */
-
@@ -24,6 +24,8 @@
 #include <votca/tools/property.h>
 #include <votca/tools/propertyiomanipulator.h>
 #include <votca/tools/globals.h>
+#include <votca/tools/profiler.h>
+#include <votca/tools/propertycache.h>
 
 namespace votca { namespace ctp {
 
@@ -63,7 +65,9 @@ public:
      * \brief Initializes a calculator from an XML file with options
      * 
      * Options are passed to a calculator by the Application
-     * These option overwrite defaults
+     * These option overwrite defaults. The options are completed in
+     * place (UpdateWithDefaults), a tree shared read-only through
+     * boost::shared_ptr<const Property> has to be copied first.
      *  
      * @param options Property object passed by the application to a calculator 
      */
@@ -97,7 +101,8 @@ protected:
     int _nThreads;
     bool _maverick;
     
-    void AddDefaults( votca::tools::Property &p, votca::tools::Property &defaults );
+    void AddDefaults( votca::tools::Property &p, const votca::tools::Property &defaults );
+    bool HasDefaults( const votca::tools::Property &defaults );
 
 };
 
@@ -106,53 +111,58 @@ inline void Calculator::LoadDefaults() {
 
 inline void Calculator::UpdateWithDefaults(votca::tools::Property *options) {
     
-    // copy options from the object supplied by the Application
+    votca::tools::ScopedTimer timer("Calculator::UpdateWithDefaults");
+
+    // options supplied by the Application, defaults are added in place
     std::string id = Identify();
-    votca::tools::Property _options = options->get( "options." + id );
+    votca::tools::Property &calc_options = options->get( "options." + id );
     
     // add default values if specified in VOTCASHARE
     char *votca_share = getenv("VOTCASHARE");
     if(votca_share == NULL) throw std::runtime_error("VOTCASHARE not set, cannot open help files.");       
     // load the xml description of the calculator (with defaults and test values)
-    std::string xmlFile = std::string(getenv("VOTCASHARE")) 
+    std::string xmlFile = std::string(votca_share)
             + std::string("/ctp/xml/") + id + std::string(".xml");
     
-    votca::tools::Property defaults, _defaults;
-    votca::tools::load_property_from_xml(_defaults, xmlFile);
-    defaults = _defaults.get( "options." + id );
-    
-    //std::cout << _options;
-    //std::cout << defaults;
+    // the description is parsed once per process and shared, it is only read
+    boost::shared_ptr<const votca::tools::Property> description = votca::tools::PropertyCache::Load(xmlFile);
+    const votca::tools::Property &defaults = description->get( "options." + id );
       
     // if a value not given or a tag not present, provide default values
-    AddDefaults( _options, defaults );   
-   
+    AddDefaults( calc_options, defaults );   
      
     // output calculator options
     std::string indent("          "); int level = 1;
     votca::tools::PropertyIOManipulator IndentedText(votca::tools::PropertyIOManipulator::TXT,level,indent);
     if ( tools::globals::verbose ) { 
-        std::cout << "\n... ... options\n" << IndentedText << _options << "... ... options\n" << std::flush;
+        std::cout << "\n... ... options\n" << IndentedText << calc_options << "... ... options\n" << std::flush;
     }
 }
 
+inline bool Calculator::HasDefaults( const votca::tools::Property &defaults ) {
+    if ( defaults.hasAttribute("default") ) return true;
+    for(votca::tools::Property::const_iterator iter = defaults.begin(); iter!=defaults.end(); ++iter)
+        if ( HasDefaults(*iter) ) return true;
+    return false;
+}
 
-inline void Calculator::AddDefaults( votca::tools::Property &p, votca::tools::Property &defaults ) {
-     
-    for(std::list<votca::tools::Property>::iterator iter = defaults.begin(); iter!=defaults.end(); ++iter) {
-        std::string name =  (*iter).path() + "." + (*iter).name();
+inline void Calculator::AddDefaults( votca::tools::Property &p, const votca::tools::Property &defaults ) {
+    
+    // walk both trees in parallel, p and defaults are nodes on the same path
+    for(votca::tools::Property::const_iterator iter = defaults.begin(); iter!=defaults.end(); ++iter) {
+        bool has_default = (*iter).hasAttribute("default");
+        votca::tools::Property *child = p.find( (*iter).name() );
 
-        votca::tools::Property rootp = *p.begin();
-        if  ( (*iter).hasAttribute("default") ) {
-            if ( rootp.exists( name ) ) {
-                //std::cout << "E " << rootp.value() << std::endl;
-                if ( rootp.HasChilds()) rootp.value() = (*iter).value();
-            } else {
-                //std::cout << "N " << (*iter).name() << std::endl;
-                rootp.add((*iter).name(), (*iter).value());
-            }
+        if ( child == NULL ) {
+            // create missing tags only if there is something to fill in
+            if ( !HasDefaults(*iter) ) continue;
+            child = &p.add( (*iter).name(), has_default ? (*iter).value() : "" );
+        } 
+        else if ( has_default && !child->HasChilds()
+                && child->value().find_first_not_of(" \t\n") == std::string::npos ) {
+            child->value() = (*iter).value();
         }
-        AddDefaults( p, (*iter) );
+        AddDefaults( *child, *iter );
     }    
 }
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_COMPRESSEDSTREAM_H
+#define	__VOTCA_TOOLS_COMPRESSEDSTREAM_H
+
+#include <string>
+#include <iostream>
+#include <boost/iostreams/filtering_stream.hpp>
+
+namespace votca { namespace tools {
+
+/**
+ * \brief helpers for compressed files and buffers
+ *
+ * Supported are gzip and bzip2, zstd if available at compile time.
+ * Files are recognized by their extension (.gz, .bz2, .zst) when written
+ * and by the magic bytes at the beginning of the file when read.
+ */
+class Compression
+{
+public:
+    enum Type { None, Gzip, Bzip2, Zstd, Auto };
+
+    /// guess the compression from the file extension
+    static Type FromFilename(const std::string &filename);
+    /// detect the compression from the first bytes of a file, None if the
+    /// file is not compressed or cannot be read
+    static Type Detect(const std::string &filename);
+    /// detect the compression from the magic bytes at the beginning of a buffer
+    static Type Detect(const char *data, size_t size);
+    /// whether this build supports a compression type
+    static bool Available(Type type);
+    static const char *Name(Type type);
+
+    /**
+     * \brief compress a buffer in memory
+     * @param level compression level, -1 for the default of the format
+     */
+    static std::string CompressBuffer(const std::string &in, Type type, int level=-1);
+    /// decompress a buffer in memory, the format is detected if type is Auto
+    static std::string DecompressBuffer(const std::string &in, Type type=Auto);
+};
+
+/**
+ * \brief input file stream with transparent decompression
+ *
+ * The compression is detected from the magic bytes, uncompressed files
+ * are read as they are. Decompression is done while reading, so the
+ * stream can be used with any istream-based loader:
+ * \code
+ * CompressedIFStream in("rdf.dist.gz");
+ * in >> table;
+ * \endcode
+ * Like ifstream, failbit is set if the file cannot be opened.
+ */
+class CompressedIFStream : public boost::iostreams::filtering_istream
+{
+public:
+    CompressedIFStream() : _type(Compression::None) {}
+    CompressedIFStream(const std::string &filename) : _type(Compression::None) { open(filename); }
+    ~CompressedIFStream();
+
+    void open(const std::string &filename);
+    void close();
+
+    /// compression of the opened file
+    Compression::Type compression() const { return _type; }
+
+private:
+    Compression::Type _type;
+};
+
+/**
+ * \brief output file stream with transparent compression
+ *
+ * By default the compression is chosen by the file extension. Gzip output
+ * is compressed in blocks by several threads, each block is written as a
+ * separate gzip member, which any gzip reader (including CompressedIFStream)
+ * reads as one stream.
+ *
+ * Call close() to catch errors while the last block is written, the
+ * destructor closes the stream silently.
+ */
+class CompressedOFStream : public boost::iostreams::filtering_ostream
+{
+public:
+    CompressedOFStream() : _type(Compression::None) {}
+    /**
+     * @param filename output file
+     * @param type compression, Auto chooses by extension
+     * @param threads number of compression threads for gzip, 0 for one per processor
+     * @param level compression level, -1 for the default of the format
+     */
+    CompressedOFStream(const std::string &filename, Compression::Type type=Compression::Auto,
+        int threads=0, int level=-1)
+        : _type(Compression::None) { open(filename, type, threads, level); }
+    ~CompressedOFStream();
+
+    void open(const std::string &filename, Compression::Type type=Compression::Auto,
+        int threads=0, int level=-1);
+    void close();
+
+    Compression::Type compression() const { return _type; }
+
+private:
+    Compression::Type _type;
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_COMPRESSEDSTREAM_H */
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_CONVOLUTION_H
+#define	__VOTCA_TOOLS_CONVOLUTION_H
+
+#include <vector>
+
+namespace votca { namespace tools {
+
+/**
+    \brief convolution of sampled data with smoothing kernels
+
+    Kernels have odd length 2m+1 and are centered, the result has the length
+    of the input. Short kernels are applied directly, long ones by FFT in
+    blocks (overlap-save), so the cost is O(N log m) instead of O(N m). Values beyond
+    the ends are given by the boundary mode.
+*/
+class Convolution
+{
+public:
+    enum Boundary {
+        /// reflect at the end points, y[-k] = y[k]
+        Mirror,
+        /// repeat the end points
+        Nearest,
+        /// zero outside
+        Zero
+    };
+
+    /**
+     * \brief kernel of the binomial filter
+     * @param passes number of Jacobi 1-2-1 passes the filter is equivalent to
+     * @param kernel coefficients C(2n, k)/4^n, negligible tails are cut
+     */
+    static void Binomial(int passes, std::vector<double> &kernel);
+
+    /**
+     * \brief sampled gaussian kernel
+     * @param sigma standard deviation in grid points
+     * @param kernel normalized coefficients, cut where they drop below
+     * double precision
+     */
+    static void Gaussian(double sigma, std::vector<double> &kernel);
+
+    /**
+     * \brief Savitzky-Golay coefficients
+     * @param m half width of the window
+     * @param order order of the fitted polynomial, less than 2m+1
+     * @param pos position the polynomial is evaluated at, -m..m
+     * @param coeff coefficients for the 2m+1 window points
+     *
+     * pos = 0 gives the smoothing kernel, other positions are used at the
+     * ends of the data.
+     */
+    static void SavitzkyGolay(int m, int order, int pos, std::vector<double> &coeff);
+
+    /**
+     * \brief convolve data with a centered kernel
+     * @param in input data
+     * @param out output, may be the same as in
+     * @param n number of points
+     * @param kernel kernel of odd length
+     * @param boundary values beyond the ends
+     */
+    static void Apply(const double *in, double *out, int n,
+        const std::vector<double> &kernel, Boundary boundary = Mirror);
+
+    /**
+     * \brief Savitzky-Golay smoothing
+     *
+     * Interior points use the smoothing kernel, the first and last m points
+     * are evaluated from the polynomial fitted to the first and last window.
+     */
+    static void ApplySavitzkyGolay(const double *in, double *out, int n, int m, int order);
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_CONVOLUTION_H */
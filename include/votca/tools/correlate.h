@@ -27,6 +27,8 @@ namespace votca { namespace tools {
 
 using namespace std;
 
+class DataChunkSource;
+
 /**
     \brief class to calculate correlations of values
 
@@ -45,6 +47,13 @@ class Correlate
          */
         void CalcCorrelations(DataCollection<double>::selection *data);
 
+        /**
+            same as CalcCorrelations, but reads the data in a single pass
+            from a chunked source, the first array of each chunk is correlated
+            with the others
+         */
+        void CalcCorrelations(DataChunkSource &source);
+
         vector< pair<string,double> > &getData() { return _corr; }
     private:
         vector< pair<string,double> > _corr;
@@ -18,8 +18,11 @@
 #define __VOTCA_TOOLS_DATABASE_H
 
 #include <string>
+#include <map>
+#include <pthread.h>
 #include <sqlite3.h>
 #include "statement.h"
+#include "mutex.h"
 
 namespace votca { namespace tools {
 
@@ -34,7 +37,7 @@ class Database
 {
 public:
 	Database();
-	~Database();
+	virtual ~Database();
 
 	sqlite3 *getSQLiteDatabase() { return _db; }
 
@@ -76,6 +79,16 @@ public:
 
 	Statement *Prepare(string sql);
 
+        /**
+         * \brief switch the database to write-ahead logging
+         *
+         * In WAL mode readers do not block the writer and vice versa, which
+         * allows to query the database from a DatabasePool while another
+         * connection is still writing to it. The mode is persistent, so
+         * it only needs to be set once by a writing connection.
+         */
+        void EnableWAL() { Exec("PRAGMA journal_mode=WAL;"); }
+
         int LastInsertRowId();
         void BeginTransaction() { Exec("BEGIN TRANSACTION;"); }
         void EndTransaction() { Exec("END TRANSACTION;"); }
@@ -86,6 +99,62 @@ protected:
 	sqlite3 *_db;
 };
 
+/**
+ *  \brief Pool of read-only connections to one database
+ *
+ *  A single sqlite3 connection serializes all queries. DatabasePool hands
+ *  out one read-only connection per thread, so that threads can query the
+ *  same database in parallel with the usual Prepare/Statement interface.
+ *  Connections are opened lazily on first use and stay open until Release
+ *  is called by the owning thread, the thread exits or the pool is
+ *  destroyed.
+ *
+ *  The database should be in WAL mode (see Database::EnableWAL) if it is
+ *  written to while the pool is in use.
+ */
+class DatabasePool
+{
+public:
+        /**
+         * @param file database file
+         * @param max_connections maximum number of connections, 0 means no limit
+         * @param shared_cache open connections with sqlite's shared cache
+         */
+        DatabasePool(const string &file, int max_connections = 0, bool shared_cache = false);
+        ~DatabasePool();
+
+        /**
+         * \brief connection of the calling thread
+         *
+         * Opens a new read-only connection if the calling thread does not
+         * own one yet. Throws if max_connections would be exceeded.
+         */
+        Database &Connection();
+
+        /**
+         * \brief close the connection of the calling thread
+         */
+        void Release();
+
+        /// number of open connections
+        int size();
+
+private:
+        string _file;
+        int _max_connections;
+        int _flags;
+        std::map<pthread_t, Database *> _connections;
+        Mutex _lock;
+        // releases the connection when its thread exits
+        pthread_key_t _key;
+
+        static void ThreadExit(void *pool);
+
+        // owns the connections and the thread key
+        DatabasePool(const DatabasePool &);
+        DatabasePool &operator=(const DatabasePool &);
+};
+
 }}
 
 #endif
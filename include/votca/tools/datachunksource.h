@@ -0,0 +1,127 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_DATACHUNKSOURCE_H
+#define	__VOTCA_TOOLS_DATACHUNKSOURCE_H
+
+#include <string>
+#include <vector>
+#include <votca/tools/datastore.h>
+#include <votca/tools/compressedstream.h>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+/**
+ * \brief source which delivers data in chunks of frames
+ *
+ * Used by the streaming variants of the analysis classes (e.g.
+ * Histogram::ProcessStream), which only keep one chunk in memory. Each
+ * chunk holds one vector per array, all with the same number of frames.
+ */
+class DataChunkSource
+{
+public:
+    virtual ~DataChunkSource() {}
+
+    /**
+     * \brief read the next chunk
+     * @param data one vector of values per array, resized by the source
+     * @return false if there is no more data
+     */
+    virtual bool Next(vector< vector<double> > &data) = 0;
+
+    /// whether the source can be read again, needed for two-pass algorithms
+    virtual bool CanRewind() { return false; }
+    /// restart at the first frame
+    virtual void Rewind();
+};
+
+/**
+ * \brief chunks from a data store
+ *
+ * Delivers the arrays matching a wildcard pattern in the order of the
+ * store.
+ */
+class DataStoreChunkSource : public DataChunkSource
+{
+public:
+    DataStoreChunkSource(const DataStoreReader &reader, const string &pattern="*",
+        size_t chunk_size=65536);
+
+    bool Next(vector< vector<double> > &data);
+    bool CanRewind() { return true; }
+    void Rewind() { _pos = 0; }
+
+    /// names of the delivered arrays
+    vector<string> getNames() const;
+
+private:
+    const DataStoreReader &_reader;
+    vector<int> _arrays;
+    size_t _chunk_size;
+    size_t _pos;
+};
+
+/**
+ * \brief chunks from a text file with one frame per line
+ *
+ * Columns are separated by white space, everything after # or @ is
+ * skipped. Compressed files are read transparently.
+ */
+class TextChunkSource : public DataChunkSource
+{
+public:
+    TextChunkSource(const string &filename, size_t chunk_size=65536);
+
+    bool Next(vector< vector<double> > &data);
+    bool CanRewind() { return true; }
+    void Rewind();
+
+private:
+    string _filename;
+    CompressedIFStream _in;
+    size_t _chunk_size;
+    size_t _columns;
+    int _line;
+};
+
+/**
+ * \brief chunks produced by a generator function
+ *
+ * The generator fills the chunk and returns false when it is exhausted.
+ * A generator cannot be rewound.
+ */
+class CallbackChunkSource : public DataChunkSource
+{
+public:
+    typedef bool (*generator_t)(vector< vector<double> > &data, void *userdata);
+
+    CallbackChunkSource(generator_t generator, void *userdata=NULL)
+        : _generator(generator), _userdata(userdata) {}
+
+    bool Next(vector< vector<double> > &data) { return _generator(data, _userdata); }
+
+private:
+    generator_t _generator;
+    void *_userdata;
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_DATACHUNKSOURCE_H */
@@ -23,10 +23,18 @@
 #include <map>
 #include <sstream>
 #include "tokenizer.h"
+#include "memstat.h"
 
 namespace votca { namespace tools {
 
 using namespace std;
+
+// shared by all element types, never destroyed
+inline MemCounter &datacollection_memory()
+{
+    static MemCounter *counter = new MemCounter("DataCollection");
+    return *counter;
+}
    
 template<typename T>
 /**
@@ -48,8 +56,10 @@ class DataCollection {
 public:
     /**
         \brief The array class, extends vector by a name tag
+
+        The elements are counted by Memory() as they are allocated.
      */
- class array  : public vector< T > 
+ class array  : public vector< T, CountingAllocator<T, datacollection_memory> > 
      {
     public:
         array(string name) {_name = name; }
@@ -84,9 +94,9 @@ public:
     };    
     
     /// constructor
-    DataCollection() {}
+    DataCollection() : _array_bytes(0), _accounted(0) { Account(); }
     /// destructor
-    ~DataCollection() { clear(); }
+    ~DataCollection() { clear(); Memory().Account(_accounted, 0); }
     
     
     /**
@@ -130,6 +140,19 @@ public:
         \brief select a set of arrays
      */
     selection *select(string strselection, selection *sel_append=NULL);
+
+    /**
+        \brief estimate the memory used by all arrays in bytes
+     */
+    size_t MemoryUsage();
+
+    /**
+        \brief counter of the memory used by all data collections
+
+        The elements of the arrays are counted by their allocator, the
+        arrays themselves when they are created or cleared.
+     */
+    static MemCounter &Memory();
     
     //map<string, selection *> &Groups() { return _group_by_name; }
     
@@ -138,8 +161,38 @@ private:
     
     map<string, array *> _array_by_name;
     //map<string, selection *> _group_by_name;
+
+    // array objects and their names, the elements are counted by the allocator
+    size_t _array_bytes;
+    // bytes reported to Memory() besides the elements
+    size_t _accounted;
+    void Account() { Memory().Account(_accounted, sizeof(*this) + tools::MemoryUsage(_data) + _array_bytes); }
+    static size_t ArrayBytes(const string &name);
 };
 
+template<typename T>
+inline MemCounter &DataCollection<T>::Memory()
+{
+    return datacollection_memory();
+}
+
+
+template<typename T>
+size_t DataCollection<T>::MemoryUsage()
+{
+    size_t bytes = sizeof(*this) + tools::MemoryUsage(_data) + _array_bytes;
+    for(iterator iter = _data.begin(); iter != _data.end(); ++iter)
+        bytes += tools::MemoryUsage(**iter);
+    return bytes;
+}
+
+template<typename T>
+size_t DataCollection<T>::ArrayBytes(const string &name)
+{
+    // the array, its name and the entry in _array_by_name
+    return sizeof(array) + 2*tools::MemoryUsage(name)
+        + MEMSTAT_MAP_NODE + sizeof(typename map<string, array *>::value_type);
+}
 
 template<typename T>
 void DataCollection<T>::clear()
@@ -150,6 +203,8 @@ void DataCollection<T>::clear()
             delete *iter;
         _data.clear();
     }
+    _array_bytes = 0;
+    Account();
 /*    _array_by_name.clear();
     {
         typename map<string, selection * >::iterator iter;
@@ -168,6 +223,8 @@ typename DataCollection<T>::array *DataCollection<T>::CreateArray(string name)
     array *a = new array(name);    
     _data.push_back(a);
     _array_by_name[name.c_str()] = a;
+    _array_bytes += ArrayBytes(a->getName());
+    Account();
     
     return a;
 }
@@ -204,8 +261,12 @@ typename DataCollection<T>::selection *DataCollection<T>::select(string strselec
     typename DataCollection<T>::selection *sel = sel_append;
     if(!sel_append) sel = new typename DataCollection<T>::selection;
     
-    for(typename map<string,array*>::iterator i=_array_by_name.begin(); i!=_array_by_name.end();++i) {
-        if(wildcmp(strselection.c_str(), (*i).second->getName().c_str()))
+    // only names starting with the literal part of the pattern can match
+    WildcardMatcher matcher(strselection);
+    const string &prefix = matcher.LiteralPrefix();
+    for(typename map<string,array*>::iterator i=_array_by_name.lower_bound(prefix);
+            i!=_array_by_name.end() && (*i).first.compare(0, prefix.size(), prefix) == 0; ++i) {
+        if(matcher.Match((*i).first))
             sel->push_back((*i).second);
     }
     return sel;
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_DATASTORE_H
+#define	__VOTCA_TOOLS_DATASTORE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <votca/tools/datacollection.h>
+#include <votca/tools/compressedstream.h>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+/**
+ * \brief chunk of one array in a data store file
+ */
+struct DataStoreChunk {
+    /// position of the data in the file
+    unsigned long long _offset;
+    /// size of the (possibly compressed) data in bytes
+    unsigned long long _size;
+    /// first frame stored in the chunk
+    unsigned long long _first;
+    /// number of frames in the chunk
+    unsigned int _frames;
+    /// Compression::Type of the chunk
+    unsigned int _compression;
+};
+
+/**
+ * \brief writer for the chunked binary format of DataCollection<double>
+ *
+ * A data store holds a fixed set of named arrays (time series) with one
+ * value per array and frame. Frames are buffered and written as one chunk
+ * per array once the chunk size is reached, the index of all chunks is
+ * written at the end of the file when the store is closed:
+ *
+ * \code
+ * DataStoreWriter out;
+ * out.Open("energies.vds", names);
+ * for(...)
+ *     out.AppendFrame(values);
+ * out.Close();
+ * \endcode
+ *
+ * An existing store can be opened for appending, new chunks then replace
+ * the old index. The data is stored in native byte order.
+ */
+class DataStoreWriter
+{
+public:
+    DataStoreWriter();
+    ~DataStoreWriter();
+
+    /**
+     * \brief open a store for writing
+     * @param filename file name
+     * @param arrays names of the arrays
+     * @param append append to an existing store, the array names must match
+     */
+    void Open(const string &filename, const vector<string> &arrays, bool append=false);
+    /**
+     * \brief open a store for writing with the arrays of a DataCollection
+     */
+    void Open(const string &filename, DataCollection<double> &data, bool append=false);
+
+    /// number of frames per chunk, default 4096
+    void setChunkSize(size_t frames) { _chunk_frames = frames; }
+    /// compression of the chunks, default Compression::None
+    void setCompression(Compression::Type compression) { _compression = compression; }
+
+    /// append one frame, values are in the order of the array names
+    void AppendFrame(const double *values);
+    void AppendFrame(const vector<double> &values);
+    /**
+     * \brief append all frames of a DataCollection
+     *
+     * Arrays are matched by name, all arrays must have the same length.
+     */
+    void Append(DataCollection<double> &data);
+
+    /// write buffered frames as (possibly short) chunks
+    void Flush();
+    /// flush and write the index
+    void Close();
+
+    /// number of frames in the store, including buffered frames
+    size_t Frames() const { return _frames + _buffered; }
+
+private:
+    string _filename;
+    fstream _out;
+    vector<string> _names;
+    vector<vector<DataStoreChunk> > _chunks;
+    vector<vector<double> > _buffer;
+    size_t _buffered;
+    size_t _frames;
+    unsigned long long _pos;
+    size_t _chunk_frames;
+    Compression::Type _compression;
+
+    void WriteIndex();
+};
+
+/**
+ * \brief reader for data store files
+ *
+ * The file is memory mapped, only the index is parsed when opening. Data
+ * of single arrays or frame ranges is read on request, uncompressed
+ * chunks are copied directly from the mapping.
+ *
+ * \code
+ * DataStoreReader in("energies.vds");
+ * DataCollection<double> data;
+ * in.Load(data, "bond*");
+ * \endcode
+ */
+class DataStoreReader
+{
+public:
+    DataStoreReader();
+    DataStoreReader(const string &filename);
+    ~DataStoreReader();
+
+    void Open(const string &filename);
+    void Close();
+
+    /// number of frames
+    size_t Frames() const { return _frames; }
+    /// names of all arrays
+    const vector<string> &Arrays() const { return _names; }
+    /// index of an array, -1 if it does not exist
+    int ArrayIndex(const string &name) const;
+    /// indices of all arrays matching a wildcard pattern
+    vector<int> Select(const string &pattern) const;
+    /// chunks of an array
+    const vector<DataStoreChunk> &Chunks(int array) const { return _chunks[array]; }
+
+    /**
+     * \brief read a range of frames of one array
+     * @param array array index
+     * @param first first frame
+     * @param n number of frames
+     * @param out buffer for n values
+     */
+    void Read(int array, size_t first, size_t n, double *out) const;
+    /// read all frames of an array
+    void Read(int array, vector<double> &out) const;
+
+    /**
+     * \brief load arrays into a DataCollection
+     * @param data collection, arrays which do not exist are created
+     * @param pattern wildcard pattern for array names
+     * @param first first frame
+     * @param n number of frames, all remaining frames if 0
+     * @return selection with the loaded arrays (caller owns it)
+     */
+    DataCollection<double>::selection *Load(DataCollection<double> &data,
+        const string &pattern="*", size_t first=0, size_t n=0) const;
+
+private:
+    string _filename;
+    const char *_map;
+    size_t _map_size;
+    vector<string> _names;
+    vector<vector<DataStoreChunk> > _chunks;
+    size_t _frames;
+
+    void ReadIndex();
+
+    // owns the mapping
+    DataStoreReader(const DataStoreReader &);
+    DataStoreReader &operator=(const DataStoreReader &);
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_DATASTORE_H */
@@ -28,6 +28,8 @@ namespace votca { namespace tools {
 
 using namespace std;
 
+class DataChunkSource;
+
 /**
     \brief class to generate histograms
 
@@ -50,6 +52,14 @@ class Histogram
             process data and generate histogram
          */
         void ProcessData(DataCollection<double>::selection *data);
+
+        /**
+            process data from a chunked source, all arrays of the source
+            are used. Only one chunk is kept in memory. With an automatic
+            interval the source is read twice, first to determine the range,
+            which requires a source that can be rewound.
+         */
+        void ProcessStream(DataChunkSource &source);
         
         /// returns the minimum value
         double getMin() const {return _min; }
@@ -83,6 +93,9 @@ class Histogram
         };          
 
     private:        
+        void Bin(const double *values, size_t n);
+        void Finish();
+
         vector<double> _pdf;
         double _min, _max;
         double _interval;
@@ -23,6 +23,7 @@
 #include <limits>
 #include <cmath>
 #include "table.h"
+#include "profiler.h"
 
 namespace votca { namespace tools {
 
@@ -134,6 +135,7 @@ inline ostream& operator<<(ostream& out, HistogramNew &h)
 template<typename iterator_type>
 inline void HistogramNew::ProcessRange(const iterator_type &begin, const iterator_type &end)
 {
+    ScopedTimer timer("HistogramNew::ProcessRange");
     for(iterator_type iter = begin; iter!=end; ++iter)
         Process(*iter);
 }
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_MEMSTAT_H
+#define	__VOTCA_TOOLS_MEMSTAT_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <iostream>
+
+namespace votca { namespace tools {
+
+/**
+ * \brief thread-safe counter of allocated bytes with peak tracking
+ *
+ * Counters register themselves at construction and are listed by
+ * MemStat::Report. They live as long as the process, e.g.
+ * \code
+ * static MemCounter *frame_memory = new MemCounter("trajectory frames");
+ * \endcode
+ */
+class MemCounter
+{
+public:
+    MemCounter(const std::string &name);
+
+    void Allocate(size_t bytes);
+    void Deallocate(size_t bytes);
+    /**
+     * \brief account for a structure which changed its size
+     * @param accounted bytes accounted for the structure so far, updated
+     * @param bytes current size of the structure, 0 when it is destroyed
+     */
+    void Account(size_t &accounted, size_t bytes);
+
+    const std::string &getName() const { return _name; }
+    /// bytes currently allocated
+    long long getCurrent() const { return _current; }
+    /// maximum of bytes allocated at the same time
+    long long getPeak() const { return _peak; }
+    /// number of allocations
+    long long getAllocations() const { return _allocations; }
+
+private:
+    std::string _name;
+    volatile long long _current;
+    volatile long long _peak;
+    volatile long long _allocations;
+
+    // counters are registered by address
+    MemCounter(const MemCounter &);
+    MemCounter &operator=(const MemCounter &);
+};
+
+/**
+ * \brief STL allocator which reports to a MemCounter
+ *
+ * The counter is a template argument, so the allocator is stateless and
+ * containers using it can be swapped and copied freely:
+ * \code
+ * MemCounter &frame_memory() { static MemCounter *c = new MemCounter("frames"); return *c; }
+ * std::vector<double, CountingAllocator<double, frame_memory> > x;
+ * \endcode
+ * Unlike Account, every reallocation is seen, so the peak is exact.
+ */
+template<typename T, MemCounter &(*Counter)()>
+class CountingAllocator : public std::allocator<T>
+{
+public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef size_t size_type;
+
+    template<typename U>
+    struct rebind { typedef CountingAllocator<U, Counter> other; };
+
+    CountingAllocator() {}
+    CountingAllocator(const CountingAllocator &a) : std::allocator<T>(a) {}
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U, Counter> &) {}
+
+    pointer allocate(size_type n, const void * = 0) {
+        pointer p = std::allocator<T>::allocate(n);
+        Counter().Allocate(n*sizeof(T));
+        return p;
+    }
+
+    void deallocate(pointer p, size_type n) {
+        Counter().Deallocate(n*sizeof(T));
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+template<typename T, typename U, MemCounter &(*Counter)()>
+inline bool operator==(const CountingAllocator<T, Counter> &, const CountingAllocator<U, Counter> &)
+{
+    return true;
+}
+
+template<typename T, typename U, MemCounter &(*Counter)()>
+inline bool operator!=(const CountingAllocator<T, Counter> &, const CountingAllocator<U, Counter> &)
+{
+    return false;
+}
+
+/**
+ * \brief registry for memory statistics
+ *
+ * Collects the MemCounters and sizes of data structures recorded with
+ * Record, e.g. the result of Property::MemoryUsage after loading an
+ * options file. Application prints the report if --memstat is given.
+ */
+class MemStat
+{
+public:
+    /**
+     * \brief record the size of a data structure
+     * @param name name of the structure
+     * @param bytes current size in bytes
+     *
+     * Recording the same name again updates the current size, the peak
+     * is kept.
+     */
+    static void Record(const std::string &name, size_t bytes);
+
+    /// resident set size of the process in bytes (0 if unknown)
+    static size_t ResidentSize();
+    /// peak resident set size of the process in bytes (0 if unknown)
+    static size_t PeakResidentSize();
+
+    /// print all counters and recorded structures
+    static void Report(std::ostream &out);
+
+private:
+    friend class MemCounter;
+    static void Register(MemCounter *counter);
+};
+
+/**
+ * \name size estimates
+ * Heap memory used by standard containers (libstdc++ layout), used by the
+ * MemoryUsage functions of the data structures.
+ */
+//@{
+/// heap memory of a string, short strings are stored inline
+inline size_t MemoryUsage(const std::string &s)
+{
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+/// heap memory of a vector of plain values
+template<typename T, typename A>
+inline size_t MemoryUsage(const std::vector<T, A> &v)
+{
+    return v.capacity()*sizeof(T);
+}
+
+/// overhead of a node in a std::map/std::set (color + 3 pointers)
+const size_t MEMSTAT_MAP_NODE = 4*sizeof(void*);
+/// overhead of a node in a std::list (2 pointers)
+const size_t MEMSTAT_LIST_NODE = 2*sizeof(void*);
+//@}
+
+}}
+
+#endif	/* __VOTCA_TOOLS_MEMSTAT_H */
@@ -21,8 +21,12 @@
 #include <map>
 #include <list>
 #include <iostream>
+#include <vector>
 #include <stdexcept>
+#include <new>
 #include <boost/lexical_cast.hpp>
+#include <boost/unordered_map.hpp>
+#include "plugin.h"
 
 namespace votca { namespace tools {
 
@@ -46,19 +50,37 @@ using namespace std;
 
     If you don't understand this, read the book by Alexandresku (Modern C++ design)
     everything explained there in detail!
+
+    Implementations can also live in shared objects which are loaded on the
+    first Create of one of their keys, see RegisterPlugin, LoadManifest and
+    Plugin. Loading a plugin registers new objects, so create the first
+    object of a plugin before the factory is used by several threads.
+
+    Objects registered with their type (Register<obj_t> or REGISTER_OBJECT)
+    can also be constructed in storage provided by the caller (CreateAt) or
+    taken from a pool kept by the factory (CreatePooled and Recycle), which
+    avoids the global allocator for short-lived objects:
+    \code
+    Calculator *c = factory.CreatePooled("rdf");
+    ...
+    factory.Recycle(c);
+    \endcode
 */
 template<typename key_t, typename T>
 class ObjectFactory
 {
 private:
     typedef T* (*creator_t)();
+    typedef T* (*placement_t)(void *);
 public:
 
     typedef T abstract_type;
     typedef map<key_t, creator_t> assoc_map;
+    typedef map<key_t, Plugin::Entry> plugin_map;
     
-    ObjectFactory() {}
-    ~ObjectFactory() {};
+    ObjectFactory() : _pool_lock(0) {}
+    /// frees the pools, pooled objects must have been recycled
+    ~ObjectFactory();
     
     /**
      * \brief register an object
@@ -70,13 +92,66 @@ public:
      */
     void Register(const key_t &key, creator_t creator );
 
+    /**
+     * \brief register an object with a placement policy
+     * \param key identifier
+     * \param creator create policy
+     * \param placement constructs the object at a given address
+     * \param size storage needed by placement
+     */
+    void Register(const key_t &key, creator_t creator, placement_t placement, size_t size);
+
     template< typename obj_t >
     void Register(const key_t &key);
 
+    /**
+     * \brief register an object provided by a shared object
+     * \param key identifier
+     * \param library shared object, loaded on the first Create of key
+     * \param create name of an extern "C" creator function in the library,
+     * empty if the library registers key itself when it is loaded
+     */
+    void RegisterPlugin(const key_t &key, const string &library, const string &create = "");
+
+    /**
+     * \brief register the objects listed in a plugin manifest
+     * \param filename manifest, see Plugin
+     * \param factory only use plugins for this factory, empty for all
+     *
+     * Keys which are already registered are not changed.
+     */
+    void LoadManifest(const string &filename, const string &factory = "");
+
     /**
        Create an instance of the object identified by key.
     */
     T *Create(const key_t &key);
+
+    /**
+     * \brief create an object in storage of the caller
+     * \param key identifier
+     * \param storage memory aligned for any type, see ObjectSize
+     * \param size size of storage
+     *
+     * Destroy the object with obj->~T() (the destructor must be virtual),
+     * do not delete it.
+     */
+    T *CreateAt(const key_t &key, void *storage, size_t size);
+
+    /**
+     * \brief create an object in a pool of the factory
+     *
+     * The object must be returned with Recycle instead of delete. Storage
+     * is allocated in blocks and reused after Recycle.
+     */
+    T *CreatePooled(const key_t &key);
+    /// destroy an object created by CreatePooled and keep its storage
+    void Recycle(T *obj);
+
+    /// storage needed by CreateAt, 0 if the object has no placement policy
+    size_t ObjectSize(const key_t &key);
+
+    /// true if key is registered, plugins do not need to be loaded for this
     bool IsRegistered(const key_t & _id) const;
 
     static ObjectFactory<key_t, T>& Instance()
@@ -85,9 +160,45 @@ public:
         return _this;
     }
 
+    /// objects which can be created without loading plugins
     const assoc_map &getObjects() { return _objects; }
+    /// objects of plugins which were not loaded yet
+    const plugin_map &getPlugins() { return _plugins; }
 private:
+    struct entry_t {
+        creator_t _creator;
+        placement_t _placement;
+        size_t _size;
+        /// recycled slots, linked through their first word
+        void *_free;
+        /// blocks of slots allocated for this object
+        vector<char *> _blocks;
+    };
+
     assoc_map _objects;
+    plugin_map _plugins;
+    /// per key data, addresses are stable
+    map<key_t, entry_t> _entries;
+    /// hashed access to _entries for Create
+    boost::unordered_map<key_t, entry_t *> _lookup;
+    /// protects the pools, held only for a few instructions
+    volatile int _pool_lock;
+    void LockPool() { while(__sync_lock_test_and_set(&_pool_lock, 1)) while(_pool_lock); }
+    void UnlockPool() { __sync_lock_release(&_pool_lock); }
+
+    /// registered entry, loads a plugin if needed, throws if key is unknown
+    entry_t &Find(const key_t &key);
+    /// load the plugin providing key, returns false if there is none
+    bool LoadPlugin(const key_t &key);
+
+    // _lookup points into _entries and the pools own their blocks
+    ObjectFactory(const ObjectFactory &);
+    ObjectFactory &operator=(const ObjectFactory &);
+
+    /// objects per block of a pool
+    static const size_t POOL_BLOCK = 64;
+    /// slots start with the owning entry, padded to keep the object aligned
+    static const size_t POOL_HEADER = 16;
 };
 
 template<class parent, class T> parent* create_policy_new()
@@ -95,28 +206,195 @@ template<class parent, class T> parent* create_policy_new()
     return new T();
 }
 
+template<class parent, class T> parent* create_policy_placement(void *storage)
+{
+    return new(storage) T();
+}
+
+template<typename key_t, typename T>
+ObjectFactory<key_t, T>::~ObjectFactory()
+{
+    for(typename map<key_t, entry_t>::iterator e = _entries.begin(); e != _entries.end(); ++e)
+        for(size_t i = 0; i < e->second._blocks.size(); ++i)
+            ::operator delete(e->second._blocks[i]);
+}
+
 template<typename key_t, typename T>
 inline void ObjectFactory<key_t, T>::Register(const key_t &key, creator_t creator)
 {
-    (void)_objects.insert(typename assoc_map::value_type(key, creator)).second;
+    Register(key, creator, NULL, 0);
+}
+
+template<typename key_t, typename T>
+inline void ObjectFactory<key_t, T>::Register(const key_t &key, creator_t creator, placement_t placement, size_t size)
+{
+    if(!_objects.insert(typename assoc_map::value_type(key, creator)).second)
+        return;
+    entry_t &entry = _entries[key];
+    entry._creator = creator;
+    entry._placement = placement;
+    entry._size = size;
+    entry._free = NULL;
+    _lookup[key] = &entry;
 }
 
 template<typename key_t, typename T>
 template< typename obj_t >
 inline void ObjectFactory<key_t, T>::Register(const key_t &key)
 {
-    Register(key, create_policy_new<abstract_type, obj_t>);
+    Register(key, create_policy_new<abstract_type, obj_t>,
+        create_policy_placement<abstract_type, obj_t>, sizeof(obj_t));
 }
 
 
+template<typename key_t, typename T>
+inline void ObjectFactory<key_t, T>::RegisterPlugin(const key_t &key, const string &library, const string &create)
+{
+    Plugin::Entry entry;
+    entry._key = boost::lexical_cast<string>(key);
+    entry._library = library;
+    entry._create = create;
+    _plugins[key] = entry;
+}
+
+template<typename key_t, typename T>
+inline void ObjectFactory<key_t, T>::LoadManifest(const string &filename, const string &factory)
+{
+    vector<Plugin::Entry> entries;
+    Plugin::ReadManifest(filename, entries);
+    for(typename vector<Plugin::Entry>::iterator e = entries.begin(); e != entries.end(); ++e) {
+        if(!factory.empty() && !e->_factory.empty() && e->_factory != factory)
+            continue;
+        key_t key = boost::lexical_cast<key_t>(e->_key);
+        if(!IsRegistered(key))
+            _plugins[key] = *e;
+    }
+}
+
+template<typename key_t, typename T>
+inline typename ObjectFactory<key_t, T>::entry_t &ObjectFactory<key_t, T>::Find(const key_t &key)
+{
+    typename boost::unordered_map<key_t, entry_t *>::const_iterator it(_lookup.find(key));
+    if (it != _lookup.end())
+        return *it->second;
+    if (LoadPlugin(key))
+        return *_lookup[key];
+    throw std::runtime_error("factory key " + boost::lexical_cast<string>(key) + " not found.");
+}
+
 template<typename key_t, typename T>
 inline T* ObjectFactory<key_t, T>::Create(const key_t &key)
 {
-    typename assoc_map::const_iterator it(_objects.find(key));
-    if (it != _objects.end())
-        return (it->second)();
-    else
-        throw std::runtime_error("factory key " + boost::lexical_cast<string>(key) + " not found.");
+    return (Find(key)._creator)();
+}
+
+template<typename key_t, typename T>
+inline size_t ObjectFactory<key_t, T>::ObjectSize(const key_t &key)
+{
+    entry_t &entry = Find(key);
+    return entry._placement ? entry._size : 0;
+}
+
+template<typename key_t, typename T>
+inline T* ObjectFactory<key_t, T>::CreateAt(const key_t &key, void *storage, size_t size)
+{
+    entry_t &entry = Find(key);
+    if(entry._placement == NULL)
+        throw std::runtime_error("factory key " + boost::lexical_cast<string>(key) + " has no placement policy.");
+    if(size < entry._size)
+        throw std::runtime_error("storage too small for factory key " + boost::lexical_cast<string>(key));
+    return (entry._placement)(storage);
+}
+
+template<typename key_t, typename T>
+T* ObjectFactory<key_t, T>::CreatePooled(const key_t &key)
+{
+    entry_t &entry = Find(key);
+    if(entry._placement == NULL)
+        throw std::runtime_error("factory key " + boost::lexical_cast<string>(key) + " has no placement policy.");
+
+    LockPool();
+    if(entry._free == NULL) {
+        // new block, all slots go to the free list
+        size_t slot = POOL_HEADER + (entry._size + POOL_HEADER - 1) / POOL_HEADER * POOL_HEADER;
+        char *block;
+        try {
+            block = (char *)::operator new(slot * POOL_BLOCK);
+        }
+        catch(...) {
+            UnlockPool();
+            throw;
+        }
+        entry._blocks.push_back(block);
+        for(size_t i = POOL_BLOCK; i > 0; --i) {
+            char *s = block + (i - 1) * slot;
+            *(void **)s = entry._free;
+            entry._free = s;
+        }
+    }
+    char *s = (char *)entry._free;
+    entry._free = *(void **)s;
+    UnlockPool();
+
+    *(entry_t **)s = &entry;
+    try {
+        return (entry._placement)(s + POOL_HEADER);
+    }
+    catch(...) {
+        LockPool();
+        *(void **)s = entry._free;
+        entry._free = s;
+        UnlockPool();
+        throw;
+    }
+}
+
+template<typename key_t, typename T>
+void ObjectFactory<key_t, T>::Recycle(T *obj)
+{
+    if(obj == NULL) return;
+    // the most derived object starts at the slot storage
+    char *s = (char *)dynamic_cast<void *>(obj) - POOL_HEADER;
+    entry_t *entry = *(entry_t **)s;
+    obj->~T();
+
+    LockPool();
+    *(void **)s = entry->_free;
+    entry->_free = s;
+    UnlockPool();
+}
+
+template<typename key_t, typename T>
+bool ObjectFactory<key_t, T>::LoadPlugin(const key_t &key)
+{
+    typename plugin_map::iterator it(_plugins.find(key));
+    if(it == _plugins.end())
+        return false;
+    Plugin::Entry entry = it->second;
+
+    if(entry._create.empty()) {
+        // the library registers its objects while it is loaded
+        Plugin::Load(entry._library);
+    }
+    else {
+        creator_t creator;
+        // POSIX way to convert the address into a function pointer
+        *(void **)(&creator) = Plugin::Symbol(entry._library, entry._create);
+        Register(key, creator);
+    }
+    _plugins.erase(key);
+    // the library might have registered further keys
+    for(typename plugin_map::iterator p = _plugins.begin(); p != _plugins.end();) {
+        if(p->second._library == entry._library && _objects.find(p->first) != _objects.end())
+            _plugins.erase(p++);
+        else
+            ++p;
+    }
+
+    if(_lookup.find(key) == _lookup.end())
+        throw std::runtime_error("plugin " + entry._library + " does not provide factory key "
+            + boost::lexical_cast<string>(key));
+    return true;
 }
 
 /*template<typename key_t, typename T>
@@ -129,7 +407,7 @@ inline static ObjectFactory<key_t, T>& ObjectFactory<key_t, T>::Instance()
 template<typename key_t, typename T>
 inline bool ObjectFactory<key_t, T>::IsRegistered(const key_t & _id) const
 {
-	return ( _objects.find(_id)!= _objects.end() );
+	return ( _objects.find(_id)!= _objects.end() || _plugins.find(_id) != _plugins.end() );
 }
 
 /*std::string list_keys() const {
@@ -146,7 +424,7 @@ class ObjectFactoryRegister {
 public:
     template<typename factory_type, typename key_type>
     ObjectFactoryRegister(factory_type &factory, key_type &key) {
-        factory.Register(key, &create_policy_new<typename factory_type::abstract_type, object_type>);
+        factory.template Register<object_type>(key);
     }
 };
 
@@ -38,6 +38,8 @@ using namespace std;
     So far only callbacks for start element handlers is implemented. The extension
     to EndElement handler (to signal if an element is close) is similar and straight
     forward. So far it was not needed and was therefore not done.
+
+    For large files with many similar elements see XMLReader.
  
   */
 class ParseXML {
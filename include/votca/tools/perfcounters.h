@@ -0,0 +1,75 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_PERFCOUNTERS_H
+#define	__VOTCA_TOOLS_PERFCOUNTERS_H
+
+namespace votca { namespace tools {
+
+/**
+ * \brief hardware performance counters of the calling thread
+ *
+ * Wraps the Linux perf_event interface to count cycles, instructions,
+ * cache misses and branch misses of the thread which created the object.
+ * Counters which cannot be opened (no Linux, no permission, not supported
+ * by the cpu or virtual machine) are reported as unavailable, all others
+ * keep working.
+ *
+ * This class is used by the Profiler to sample counters around timed
+ * regions, see Profiler::EnableCounters.
+ */
+class PerfCounters
+{
+public:
+    enum counter_t {
+        Cycles = 0,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+        NumCounters
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    /// is the counter available?
+    bool Available(int counter) const { return _fd[counter] >= 0; }
+    /// is any counter available?
+    bool AnyAvailable() const;
+
+    /**
+     * \brief read all counters
+     * @param values storage for NumCounters values, unavailable counters are 0
+     *
+     * Values are scaled if the kernel had to multiplex the counters.
+     */
+    void Read(unsigned long long *values) const;
+
+    /// name of a counter for output
+    static const char *Name(int counter);
+
+private:
+    int _fd[NumCounters];
+
+    // no copies, the object owns file descriptors
+    PerfCounters(const PerfCounters &);
+    PerfCounters &operator=(const PerfCounters &);
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_PERFCOUNTERS_H */
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_PLUGIN_H
+#define	__VOTCA_TOOLS_PLUGIN_H
+
+#include <string>
+#include <vector>
+
+namespace votca { namespace tools {
+
+/**
+ * \brief loading of shared objects at runtime
+ *
+ * Helper for ObjectFactory to load implementations only when they are
+ * needed. A manifest describes which factory keys a shared object provides:
+ * \code
+ * <plugins>
+ *   <plugin library="libcalculators.so" factory="calculators">
+ *     <object key="rdf"/>
+ *     <object key="density" create="create_density"/>
+ *   </plugin>
+ * </plugins>
+ * \endcode
+ * Objects without create are registered by the library itself when it is
+ * loaded (REGISTER_OBJECT or Register in a static initializer), otherwise
+ * create names an extern "C" function without arguments returning a new
+ * object. Relative library paths are relative to the manifest.
+ *
+ * Self-registering libraries must see the same factory as the program:
+ * this is the case if the factory lives in a shared library or if the
+ * program is linked with -rdynamic (ENABLE_EXPORTS in CMake).
+ *
+ * Libraries are loaded once and stay loaded until the program ends.
+ */
+class Plugin
+{
+public:
+    /// an object provided by a library, as listed in a manifest
+    struct Entry {
+        std::string _key;
+        std::string _library;
+        /// creator function, empty if the library registers the object itself
+        std::string _create;
+        /// factory the object belongs to, empty for any
+        std::string _factory;
+    };
+
+    /**
+     * \brief load a shared object
+     * @param library file name, searched like dlopen does if it contains no slash
+     * @return handle of the library
+     *
+     * Throws runtime_error if the library cannot be loaded.
+     */
+    static void *Load(const std::string &library);
+    /// true if the library was loaded by Load
+    static bool IsLoaded(const std::string &library);
+    /**
+     * \brief address of a symbol, the library is loaded if needed
+     *
+     * Throws runtime_error if the symbol does not exist.
+     */
+    static void *Symbol(const std::string &library, const std::string &symbol);
+
+    /**
+     * \brief read the entries of a manifest
+     * @param filename manifest file
+     * @param entries entries are appended
+     */
+    static void ReadManifest(const std::string &filename, std::vector<Entry> &entries);
+
+    /**
+     * \brief find manifests
+     * @param path colon separated list of directories
+     * @return all files ending with .xml in these directories, sorted by
+     * name within a directory
+     */
+    static std::vector<std::string> FindManifests(const std::string &path);
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_PLUGIN_H */
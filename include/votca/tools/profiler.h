@@ -0,0 +1,154 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_PROFILER_H
+#define	__VOTCA_TOOLS_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include "perfcounters.h"
+
+namespace votca { namespace tools {
+
+/**
+ * \brief hierarchical timer and counter registry
+ *
+ * Timed regions are opened and closed with Start/Stop (usually through
+ * ScopedTimer). Every thread records into its own tree of regions, so no
+ * locking is needed while timing. Report merges the trees of all threads
+ * and prints the accumulated times hierarchically. When a thread exits,
+ * its tree is merged into a common tree of finished threads and its
+ * counters are closed, so short-lived pool threads do not pile up.
+ *
+ * The profiler is disabled by default, in this case a ScopedTimer only
+ * checks a flag and does nothing else.
+ *
+ * If hardware counters are switched on (EnableCounters), every region
+ * additionally accumulates the PerfCounters of the thread.
+ */
+class Profiler
+{
+public:
+    /// one timed region in the tree of a thread
+    struct Node {
+        Node(const char *name, Node *parent)
+            : _name(name), _parent(parent), _calls(0), _count(0), _time(0), _start(0)
+        {
+            for(int i=0; i<PerfCounters::NumCounters; ++i)
+                _counters[i] = _counters_start[i] = 0;
+        }
+        ~Node();
+
+        /// find or create a child region
+        Node *Child(const char *name);
+
+        std::string _name;
+        Node *_parent;
+        std::vector<Node *> _childs;
+        /// number of times the region was entered
+        unsigned long _calls;
+        /// user defined counter, see Profiler::Count
+        unsigned long _count;
+        /// accumulated time in seconds
+        double _time;
+        /// start time of the currently open region
+        double _start;
+        /// accumulated hardware counters
+        unsigned long long _counters[PerfCounters::NumCounters];
+        /// counter values when the currently open region was entered
+        unsigned long long _counters_start[PerfCounters::NumCounters];
+    };
+
+    /// switch profiling on or off
+    static void Enable(bool enable = true) { _enabled = enable; }
+    /// is profiling switched on?
+    static bool IsEnabled() { return _enabled; }
+
+    /**
+     * \brief sample hardware counters in every region
+     *
+     * Counters are opened per thread on first use. If they are not
+     * available, only times are reported.
+     */
+    static void EnableCounters(bool enable = true) { _counters_enabled = enable; }
+    /// are hardware counters switched on?
+    static bool CountersEnabled() { return _counters_enabled; }
+
+    /**
+     * \brief open a region in the calling thread
+     * @param name name of region, nested regions form the hierarchy
+     */
+    static void Start(const char *name);
+    /// close the region opened last in the calling thread
+    static void Stop();
+
+    /**
+     * \brief add to a counter in the current region of the calling thread
+     * @param name name of the counter
+     * @param n increment
+     */
+    static void Count(const char *name, unsigned long n = 1);
+
+    /**
+     * \brief print the merged profile of all threads
+     */
+    static void Report(std::ostream &out);
+
+    /// discard all collected data, only call while no other thread is profiling
+    static void Clear();
+
+    /// wall clock time in seconds (monotonic)
+    static double Now();
+
+private:
+    static bool _enabled;
+    static bool _counters_enabled;
+};
+
+/**
+ * \brief times a region from construction till destruction
+ *
+ * \code
+ * void CubicSpline::Fit(...)
+ * {
+ *     ScopedTimer timer("CubicSpline::Fit");
+ *     ...
+ * }
+ * \endcode
+ */
+class ScopedTimer
+{
+public:
+    ScopedTimer(const char *name)
+        : _active(Profiler::IsEnabled())
+    {
+        if(_active) Profiler::Start(name);
+    }
+
+    ~ScopedTimer()
+    {
+        if(_active) Profiler::Stop();
+    }
+
+private:
+    bool _active;
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_PROFILER_H */
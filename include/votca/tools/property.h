@@ -25,7 +25,11 @@
 #include <stdexcept>
 #include "lexical_cast.h"
 #include <boost/algorithm/string/trim.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <stdlib.h>
+#include <vector>
 
 #include "vec.h"
 #include "tokenizer.h"
@@ -45,17 +49,51 @@ namespace votca { namespace tools {
  * The property object can be output to an ostream using format modifiers:
  * cout << XML << property;
  * Supported formats are XML, TXT, TEX, HLP
+ *
+ * Copies of a Property are deep. To hand a tree to several users (e.g.
+ * calculators in different threads) without copying it, share it read-only
+ * through a boost::shared_ptr<const Property>, see Freeze and
+ * PropertyCache. Const member functions never modify the tree, so any
+ * number of threads can read it at the same time. Only whole trees are
+ * shared, a subtree handed out as Property * (e.g. to
+ * Calculator::Initialize, which may add defaults) is a deep copy.
+ *
+ * For large trees a flat index from the full path to the node can be enabled
+ * with EnableIndex, see there.
  */
 class Property {
     
     /// \brief outputs the property to the ostream
-    friend std::ostream &operator<<(std::ostream &out, Property& p);
+    friend std::ostream &operator<<(std::ostream &out, const Property& p);
+    friend void load_properties_from_xml(Property &p, const vector<string> &filenames, int nthreads);
    
 public:
-    Property() : _path("") {}
+    Property() : _parent(NULL), _path("") {}
     
     Property(const string &name, const string &value, const string &path) 
-        : _name(name), _value(value), _path(path) {}
+        : _parent(NULL), _value(value), _name(name), _path(path) {}
+
+    /// deep copy, the path index is not copied
+    Property(const Property &p);
+
+    Property &operator=(const Property &p);
+
+    /**
+     * \brief exchange the contents of two trees in O(1), no nodes are copied
+     *
+     * Both nodes must be roots, the names and paths stay in place.
+     */
+    void swap(Property &p);
+
+    /**
+     * \brief move the tree into a shared read-only tree
+     * @return the tree, this node is left empty
+     *
+     * No nodes are copied. Only a root can be frozen, copy a subtree into a
+     * new Property first. The result can be handed to any number of
+     * readers, copy it if changes are needed.
+     */
+    boost::shared_ptr<const Property> Freeze();
     
     /**
      * \brief add a new property to structure
@@ -82,13 +120,24 @@ public:
      * found a runtime_exception is thrown.
      */
     Property &get(const string &key);
+    const Property &get(const string &key) const;
+
+    /**
+     * \brief find existing property
+     * @param key identifier
+     * @return pointer to the property or NULL if it does not exist
+     *
+     * Same as get, but does not throw if the property is not found.
+     */
+    Property *find(const string &key);
+    const Property *find(const string &key) const;
 
     /**
      * \brief check weather property exists
      * @param key identifier
      * @return true or false
      */
-    bool exists(const string &key);
+    bool exists(const string &key) const;
     
     /**
      * \brief select property based on a filter
@@ -99,24 +148,26 @@ public:
      * wildcards "*" and "?". Example: "base.item*.value"
     */
     std::list<Property *> Select(const string &filter);
+    std::list<const Property *> Select(const string &filter) const;
     
     /**
      * \brief reference to value of property
      * @return string content
      */
     string &value() { return _value; }
+    const string &value() const { return _value; }
     /**
      * \brief name of property
      * @return name
      */
-    string name() { return _name; }
+    string name() const { return _name; }
     /**
      * \brief full path of property (including parents)
      * @return path
      *
      * e.g. cg.inverse.value
      */
-    string path() { return _path; }
+    string path() const { return _path; }
     /**
      * \brief return value as type
      *
@@ -129,16 +180,19 @@ public:
      * \brief does the property has childs?
      * \return true or false
      */
-    bool HasChilds() { return !_map.empty(); }
+    bool HasChilds() const { return !_map.empty(); }
     
     /// iterator to iterate over properties
     typedef list<Property>::iterator iterator;  
+    typedef list<Property>::const_iterator const_iterator;
     /// \brief iterator to first child property
     iterator begin() { return _properties.begin(); }
+    const_iterator begin() const { return _properties.begin(); }
     /// \brief end iterator for child properties
     iterator end() { return _properties.end(); }
+    const_iterator end() const { return _properties.end(); }
     /// \brief number of child properties
-    list<Property>::size_type size() { return _properties.size(); }
+    list<Property>::size_type size() const { return _properties.size(); }
 
     // throw error and comment (with filename+code line)
     void throwRuntimeError(string message);
@@ -149,7 +203,7 @@ public:
      * p.getAttribute<int>() returns an integer
      */
     template<typename T>
-    T getAttribute(const string &attribute);
+    T getAttribute(const string &attribute) const;
     /**
      * \brief set an attribute
      */
@@ -158,25 +212,29 @@ public:
     /**
      * \brief return true if a node has attributes
      */
-    bool hasAttributes() { return _attributes.size() > 0; }
+    bool hasAttributes() const { return _attributes.size() > 0; }
     /**
      * \brief return true if an attribute exists
      */
-    bool hasAttribute(const string &attribute);
+    bool hasAttribute(const string &attribute) const;
     /** for iterator-based access of Attributes */
     typedef std::map<string,string>::iterator AttributeIterator;
+    typedef std::map<string,string>::const_iterator ConstAttributeIterator;
     /**
      * \brief returns an iterator to an attribute
      */    
     AttributeIterator findAttribute(const string &attribute){ return _attributes.find(attribute); }
+    ConstAttributeIterator findAttribute(const string &attribute) const { return _attributes.find(attribute); }
     /**
      * \brief returns an iterator to the first attribute
      */    
     AttributeIterator firstAttribute(){ return _attributes.begin(); }   
+    ConstAttributeIterator firstAttribute() const { return _attributes.begin(); }   
     /**
      * \brief returns an iterator to the last attribute
      */    
     AttributeIterator lastAttribute(){ return _attributes.end(); }   
+    ConstAttributeIterator lastAttribute() const { return _attributes.end(); }   
     /**
      * \brief return attribute as type
      *
@@ -187,14 +245,87 @@ public:
     T getAttribute( AttributeIterator it);    
  
     static int getIOindex(){return IOindex;};
+
+    /**
+     * \brief estimate the memory used by this node and all its children
+     * @return bytes including the size of the node itself
+     */
+    size_t MemoryUsage() const;
+
+    /**
+     * \brief enable a flat index from path to node for this (sub)tree
+     *
+     * With the index, get, find and exists on full paths relative to this
+     * node are a single hash lookup and Select only visits the nodes
+     * starting with the part of the filter before the first wildcard.
+     * The index is built here for the whole subtree. Nodes added anywhere
+     * in the subtree are added to the index. Other changes of the structure
+     * inside the subtree (assignment or swap of a node) make the next
+     * non-const lookup rebuild it, changes elsewhere do not affect it.
+     * Const lookups never modify the index and walk the tree while it is
+     * out of date, so several threads can read an indexed tree.
+     */
+    void EnableIndex(bool enable = true);
+    /// true if a path index was enabled for this node
+    bool HasIndex() const { return _index.get() != NULL; }
     
 private:        
+    /// flat index from relative path to node
+    struct PathIndex {
+        struct entry_t {
+            string _path;
+            Property *_node;
+            /// position in document order
+            size_t _order;
+            bool operator<(const entry_t &e) const
+                { return _path < e._path || (_path == e._path && _order < e._order); }
+        };
+        /// the structure has changed in a way the index was not updated for
+        bool _stale;
+        /// false if a name contains a dot or a child is not listed under its
+        /// name, the paths do not match the walk then
+        bool _plain;
+        /// true if _entries is sorted by path
+        bool _sorted;
+        /// false if nodes were added out of document order, _order is wrong then
+        bool _ordered;
+        /// node reached by walking the path, the last child if names repeat
+        boost::unordered_map<string, Property *> _lookup;
+        /// all nodes, including repeated names
+        std::vector<entry_t> _entries;
+
+        void Insert(Property *node, const string &path, bool visible);
+        void Build(Property *node, const string &path, bool visible);
+        /// remove a subtree which is no longer reached by its paths
+        void Hide(Property *node, const string &path);
+    };
+
+    /// path index, rebuilt if the tree has changed, NULL if it cannot be used
+    PathIndex *Index();
+    /// path index if it is up to date, else NULL
+    const PathIndex *ValidIndex() const;
+    template<typename P>
+    static void IndexSelect(const PathIndex *index, const string &filter, std::list<P> &selection);
+
+    /// add a new child (hiding a previous child with that name) to the indices above
+    void AddToIndex(Property *child, Property *hidden);
+    /// the structure of this subtree has changed, marks the indices of this node
+    /// and its parents out of date
+    void Invalidate();
+    /// exchange children, attributes and value, keeps name, path and index
+    void SwapContents(Property &p);
+
+    /// node this one is a child of, NULL for the root
+    Property *_parent;
+
     map<string,Property*> _map;
     map<string,string> _attributes;
     list<Property> _properties;
+    string _value;
+
+    boost::scoped_ptr<PathIndex> _index;
     
     string _name;
-    string _value;
     string _path;
 
     static const int IOindex; 
@@ -214,19 +345,41 @@ inline Property &Property::add(const string &key, const string &value)
     string path = _path;
     if(path != "") path = path + ".";
     _properties.push_back(Property(key, value, path + _name ));
-    _map[key] = &(_properties.back());
-    return _properties.back();
+    Property &p = _properties.back();
+    p._parent = this;
+    Property *&entry = _map[key];
+    Property *hidden = entry;
+    entry = &p;
+    AddToIndex(&p, hidden);
+    return p;
 }
 
-inline bool Property::exists(const string &key)
+inline bool Property::exists(const string &key) const
 {
-    try { get(key); }
-    catch(std::exception &err) { return false;}
-    return true;
+    return find(key) != NULL;
 }
     
 bool load_property_from_xml(Property &p, string file);
 
+/**
+ * \brief load several XML files concurrently
+ * @param properties filled with one tree per file, in the order of the files
+ * @param filenames files to load
+ * @param nthreads number of threads, 0 for one per processor
+ *
+ * If files cannot be loaded, the error of the first of them is thrown
+ * after all files were processed.
+ */
+void load_properties_from_xml(vector<Property> &properties, const vector<string> &filenames, int nthreads = 0);
+
+/**
+ * \brief load several XML files concurrently into one tree
+ *
+ * Same as calling load_property_from_xml for every file in order, the root
+ * elements of the files are added to p in the order of the files.
+ */
+void load_properties_from_xml(Property &p, const vector<string> &filenames, int nthreads = 0);
+
 // TO DO: write a better function for this!!!!
 template<>
 inline bool Property::as<bool>() const
@@ -283,8 +436,8 @@ inline vector<double> Property::as<vector <double> >() const {
     return tmp;
 }
 
-inline bool Property::hasAttribute(const string &attribute) {
-    std::map<string,string>::iterator it;
+inline bool Property::hasAttribute(const string &attribute) const {
+    std::map<string,string>::const_iterator it;
     it = _attributes.find(attribute);
     if ( it == _attributes.end() ) return false;
     return true;
@@ -301,14 +454,14 @@ inline T Property::getAttribute(std::map<string,string>::iterator it)
 }
 
 template<typename T>
-inline T Property::getAttribute(const string &attribute)
+inline T Property::getAttribute(const string &attribute) const
 {
-    std::map<string,string>::iterator it;
+    std::map<string,string>::const_iterator it;
     
     it = _attributes.find(attribute);
     
     if (it != _attributes.end()) {
-        return lexical_cast<T>(_attributes[attribute], "wrong type in attribute " + attribute + " of element " + _path + "."  + _name + "\n");
+        return lexical_cast<T>(it->second, "wrong type in attribute " + attribute + " of element " + _path + "."  + _name + "\n");
     } else {
         throw std::runtime_error("attribute " + attribute + " not found\n");
     }
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_PROPERTYCACHE_H
+#define	__VOTCA_TOOLS_PROPERTYCACHE_H
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <votca/tools/property.h>
+
+namespace votca { namespace tools {
+
+/**
+ * \brief process-wide cache of parsed XML files
+ *
+ * Programs running many jobs in one process (see Application --batch)
+ * parse option and description files only once. A file is parsed again
+ * if its modification time or size changed.
+ *
+ * The returned tree is shared by all users of the cache and read-only,
+ * copy it if changes are needed.
+ */
+class PropertyCache
+{
+public:
+    /**
+     * \brief load an XML file through the cache
+     * @param filename XML file
+     * @return parsed tree, shared with other users
+     */
+    static boost::shared_ptr<const Property> Load(const std::string &filename);
+
+    /// remove a file from the cache
+    static void Invalidate(const std::string &filename);
+    /// remove all files from the cache
+    static void Clear();
+
+    /// number of loads served from the cache
+    static size_t getHits();
+    /// number of files parsed
+    static size_t getMisses();
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_PROPERTYCACHE_H */
@@ -19,8 +19,10 @@
 #define	_RANGEPARSER_H
 
 #include <list>
+#include <vector>
 #include <string>
 #include <ostream>
+#include <stdexcept>
 
 namespace votca { namespace tools {
 
@@ -30,6 +32,21 @@ using namespace std;
  * \brief RangeParser
  *
  * parse strings like min:step:max, not flexible enough yet to be really useful
+ *
+ * Iterating returns the blocks as given, including duplicates. In addition
+ * the range is compiled into sorted, merged runs (where blocks with
+ * different strides overlap, the run stores which numbers of one period
+ * are taken, or the numbers themselves if that period is long compared to
+ * how many are taken), which answer membership queries and split the selected
+ * numbers into chunks, e.g. to distribute frames among threads:
+ * \code
+ * RangeParser frames;
+ * frames.Parse("0:999,2000:10:5000");
+ * if(frames.contains(k)) ...
+ * vector<RangeParser> parts = frames.Split(nthreads);
+ * \endcode
+ * The runs are compiled by the first query after Parse or Add, so call
+ * count() once before querying the same range from several threads.
  */
 class RangeParser
 {
@@ -39,6 +56,23 @@ public:
     void Parse(string range);
 
     void Add(int begin, int end, int stride=1);
+
+    /// true if the number is in the range, O(log(number of runs))
+    bool contains(int k) const;
+    /// number of distinct numbers in the range
+    size_t count() const { Compile(); return _count; }
+    /**
+     * \brief split into contiguous parts of (almost) equal count
+     * @param n number of parts
+     * @return parts in ascending order, fewer than n if count() < n
+     *
+     * Each number of the range is in exactly one part and the parts
+     * are ascending. Duplicates are removed, each block of a part is
+     * ascending. Where blocks of different strides overlap, a part gets
+     * one block per number taken in the common period, so its blocks
+     * interleave.
+     */
+    vector<RangeParser> Split(int n) const;
     
 private:
     struct block_t {
@@ -79,8 +113,45 @@ private:
     
     void ParseBlock(string block);
     int ToNumber(string str);
+    /// build the merged runs from the blocks, if they have changed
+    void Compile() const;
         
     list< block_t > _blocks;    
+
+    /// numbers _begin, _begin + _stride, ..., _last if _bits < 0 and _list < 0,
+    /// _begin + q * _stride + i for the bits i set in the mask at _bits, or
+    /// the _stride sorted numbers at _list in _numbers
+    struct run_t {
+        int _begin, _last;
+        long long _stride;
+        /// numbers in this run and in all runs before
+        size_t _count, _offset;
+        /// first word of the mask in _bits
+        long _bits;
+        /// first of the listed numbers in _numbers
+        long _list;
+
+        bool operator<(const run_t &r) const
+            { return _begin < r._begin || (_begin == r._begin && _last < r._last); }
+        /// append a run if both form one progression
+        bool Merge(const run_t &next);
+        static bool BeginLess(int k, const run_t &r) { return k < r._begin; }
+        static bool OffsetLess(size_t i, const run_t &r) { return i < r._offset; }
+    };
+    /// add the union of the runs runs[i..j) covering all of [first, last]
+    void CompileSegment(const vector<run_t> &runs, size_t i, size_t j,
+        long long first, long long last) const;
+    /// numbers of a masked or listed run below r._begin + n
+    size_t Rank(const run_t &r, long long n) const;
+    /// i-th number of a masked or listed run
+    long long Nth(const run_t &r, size_t i) const;
+
+    /// sorted and disjoint
+    mutable vector<run_t> _runs;
+    mutable vector<unsigned long> _bits;
+    mutable vector<int> _numbers;
+    mutable size_t _count;
+    mutable bool _compiled;
     
     bool _has_begin, _has_end;
     int _begin, _end;
@@ -91,7 +162,10 @@ private:
 
 inline void RangeParser::Add(int begin, int end, int stride)
 {
+    if(stride == 0)
+        throw runtime_error("invalid range: stride must not be 0");
     _blocks.push_back(block_t(begin, end, stride));
+    _compiled = false;
 }
 
 inline RangeParser::iterator RangeParser::begin()
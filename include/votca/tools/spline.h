@@ -11,6 +11,7 @@
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
 #include <boost/numeric/ublas/vector_expression.hpp>
+#include "profiler.h"
 
 namespace votca{namespace tools{
 
@@ -151,6 +152,7 @@ protected:
 template<typename vector_type1, typename vector_type2>
 inline void Spline::Calculate(vector_type1 &x, vector_type2 &y)
 {
+    ScopedTimer timer("Spline::Calculate");
     for(size_t i=0; i<x.size(); ++i)
         y(i) = Calculate(x(i));
 }
@@ -158,6 +160,7 @@ inline void Spline::Calculate(vector_type1 &x, vector_type2 &y)
 template<typename vector_type1, typename vector_type2>
 inline void Spline::CalculateDerivative(vector_type1 &x, vector_type2 &y)
 {
+    ScopedTimer timer("Spline::CalculateDerivative");
     for(size_t i=0; i<x.size(); ++i)
         y(i) = CalculateDerivative(x(i));
 }
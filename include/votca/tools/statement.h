@@ -20,6 +20,8 @@
 #include <sqlite3.h>
 #include <stdexcept>
 #include <string>
+#include <vector>
+#include <string.h>
 #include "lexical_cast.h"
 
 namespace votca { namespace tools {
@@ -46,6 +48,25 @@ public:
         template<typename T>
 		void Bind(int col, const T &value);
 
+	/**
+         * \brief bind a binary blob to prepared statement
+         * @param col column number, sqlite starts counting with 1
+         * @param data pointer to the data
+         * @param size size of data in bytes
+         * @param copy if false, data must stay valid until the statement is
+         *        reset or re-bound (no copy is made by sqlite)
+         */
+        void BindBlob(int col, const void *data, int size, bool copy = true);
+
+        /**
+         * \brief bind the content of a vector as binary blob
+         *
+         * Used to store arrays (e.g. coordinates, spline coefficients) in a
+         * single column without converting them to text.
+         */
+        template<typename T>
+        void BindBlob(int col, const std::vector<T> &v, bool copy = true);
+
 	/**
          * \brief read a column after a select statement was executed
          * @param col column number, sqlite starts counting with 0 here
@@ -53,6 +74,78 @@ public:
 	template<typename T>
 	T Column(int col);
 
+        /**
+         * \brief read a text column without copying it
+         * @param col column number, sqlite starts counting with 0 here
+         * @param size if not NULL, length of the text in bytes is stored here
+         * @return pointer to the text, valid until the next Step or Reset
+         */
+        const char *ColumnText(int col, int *size = NULL);
+
+        /**
+         * \brief zero-copy view of a blob column
+         *
+         * The view points into memory owned by sqlite and is only valid
+         * until the next call of Step or Reset. Elements are read with
+         * memcpy, so the blob does not need to be aligned.
+         */
+        template<typename T>
+        class BlobView {
+        public:
+            BlobView() : _data(NULL), _size(0) {}
+            BlobView(const void *data, size_t bytes)
+                : _data((const char*)data), _size(bytes/sizeof(T)) {}
+
+            /// number of elements of type T in the blob
+            size_t size() const { return _size; }
+            bool empty() const { return _size == 0; }
+            /// raw pointer to the data
+            const void *data() const { return _data; }
+
+            T operator[](size_t i) const {
+                T value;
+                memcpy(&value, _data + i*sizeof(T), sizeof(T));
+                return value;
+            }
+
+            /// copy the content of the view into a vector
+            void CopyTo(std::vector<T> &v) const {
+                v.resize(_size);
+                if(_size) memcpy(&v[0], _data, _size*sizeof(T));
+            }
+        private:
+            const char *_data;
+            size_t _size;
+        };
+
+        /**
+         * \brief read a blob column without copying it
+         * @param col column number, sqlite starts counting with 0 here
+         * @return view on the blob, valid until the next Step or Reset
+         */
+        template<typename T>
+        BlobView<T> ColumnBlob(int col);
+
+        /**
+         * \brief fetch one column of the whole result set
+         * @param col column number, sqlite starts counting with 0 here
+         * @param values values are appended to this vector
+         * @return number of rows read
+         *
+         * Steps through all remaining rows of the statement. Throws if sqlite
+         * reports an error.
+         */
+        template<typename T>
+        size_t FetchColumn(int col, std::vector<T> &values);
+
+        /**
+         * \brief fetch all columns of the whole result set
+         * @param values one vector per column, values are appended
+         * @return number of rows read
+         */
+        template<typename T>
+        size_t FetchColumns(std::vector< std::vector<T> > &values);
+
 
         /**
          * \brief perform a step
@@ -84,6 +177,50 @@ protected:
 	friend class Database;
 };
 
+template<typename T>
+inline void Statement::BindBlob(int col, const std::vector<T> &v, bool copy)
+{
+    BindBlob(col, v.empty() ? NULL : (const void*)&v[0], v.size()*sizeof(T), copy);
+}
+
+template<typename T>
+inline Statement::BlobView<T> Statement::ColumnBlob(int col)
+{
+    const void *data = sqlite3_column_blob(_stmt, col);
+    return BlobView<T>(data, sqlite3_column_bytes(_stmt, col));
+}
+
+template<typename T>
+size_t Statement::FetchColumn(int col, std::vector<T> &values)
+{
+    size_t n = 0;
+    int ret;
+    while((ret = Step()) == SQLITE_ROW) {
+        values.push_back(Column<T>(col));
+        ++n;
+    }
+    if(ret != SQLITE_DONE)
+        throw std::runtime_error("Statement::FetchColumn failed. Return code was " + boost::lexical_cast<std::string>(ret));
+    return n;
+}
+
+template<typename T>
+size_t Statement::FetchColumns(std::vector< std::vector<T> > &values)
+{
+    size_t n = 0;
+    int ret;
+    int ncols = sqlite3_column_count(_stmt);
+    values.resize(ncols);
+    while((ret = Step()) == SQLITE_ROW) {
+        for(int i=0; i<ncols; ++i)
+            values[i].push_back(Column<T>(i));
+        ++n;
+    }
+    if(ret != SQLITE_DONE)
+        throw std::runtime_error("Statement::FetchColumns failed. Return code was " + boost::lexical_cast<std::string>(ret));
+    return n;
+}
+
 inline int Statement::InsertStep()
 {
     int ret = Step();
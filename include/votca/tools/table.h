@@ -21,6 +21,7 @@
 #include <iostream>
 #include <boost/numeric/ublas/vector.hpp>
 #include <string>
+#include "memstat.h"
 
 namespace votca { namespace tools {
 
@@ -44,7 +45,9 @@ public:
     Table() ;
     Table(Table &tbl);
         
-    ~Table() {};
+    ~Table();
+
+    Table &operator=(const Table &tbl);
     
     void clear(void);
     
@@ -68,7 +71,23 @@ public:
     void Load(string filename);
     void Save(string filename) const;       
     
+    /// applies the 1-2-1 stencil Nsmooth times in place, the end points are kept
     void Smooth(int Nsmooth);
+    /**
+     * \brief smooth with the binomial kernel
+     * @param passes width, the kernel equals passes sweeps of the 1-2-1 stencil
+     *
+     * The result equals passes Jacobi sweeps of the 1-2-1 stencil (all
+     * points updated from the values of the previous sweep) with mirrored
+     * ends. It is not the result of Smooth(passes), which sweeps in place
+     * and keeps the end points fixed. The cost does not depend on passes,
+     * see Convolution.
+     */
+    void SmoothBinomial(int passes);
+    /// smooth with a gaussian kernel, sigma in grid points, ends mirrored
+    void SmoothGaussian(double sigma);
+    /// Savitzky-Golay filter with window 2m+1 and polynomial order
+    void SmoothSavitzkyGolay(int m, int order);
 
     bool GetHasYErr() { return _has_yerr; }
     void SetHasYErr(bool has_yerr) { _has_yerr = has_yerr; }
@@ -77,6 +96,11 @@ public:
     ub::vector<double> &y() { return _y; }
     ub::vector<char> &flags() { return _flags; }
     ub::vector<double> &yerr() { return _yerr; }
+
+    const ub::vector<double> &x() const { return _x; }
+    const ub::vector<double> &y() const { return _y; }
+    const ub::vector<char> &flags() const { return _flags; }
+    const ub::vector<double> &yerr() const { return _yerr; }
     
     void push_back(double x, double y, char flags);
 
@@ -88,6 +112,12 @@ public:
         _error_details = str;
     }
 
+    /// estimate the memory used by the table in bytes
+    size_t MemoryUsage() const;
+
+    /// counter of the memory used by the columns of all tables
+    static MemCounter &Memory();
+
 private:
     ub::vector<double> _x;
     ub::vector<double> _y;       
@@ -103,15 +133,21 @@ private:
 
     string _comment_line;
 
+    // column bytes reported to Memory()
+    size_t _accounted;
+    void Account();
 };
 
 inline Table::Table()
+    : _accounted(0)
 {
     _has_yerr = false;
+    _has_comment = false;
     _error_details = "";
 }
 
 inline Table::Table(Table &tbl)
+    : _has_yerr(tbl._has_yerr), _accounted(0)
 {
     resize(tbl.size());
     _x = tbl._x;
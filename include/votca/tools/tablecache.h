@@ -0,0 +1,60 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_TABLECACHE_H
+#define	__VOTCA_TOOLS_TABLECACHE_H
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <votca/tools/table.h>
+
+namespace votca { namespace tools {
+
+/**
+ * \brief process-wide cache of loaded tables
+ *
+ * Like PropertyCache for XML files: programs running many jobs in one
+ * process (see Application --batch) read potentials and distributions
+ * only once. A file is read again if its modification time or size changed.
+ *
+ * The returned table is shared by all users of the cache and read-only,
+ * copy it if changes are needed.
+ */
+class TableCache
+{
+public:
+    /**
+     * \brief load a table through the cache
+     * @param filename table file, as for Table::Load
+     * @return loaded table, shared with other users
+     */
+    static boost::shared_ptr<const Table> Load(const std::string &filename);
+
+    /// remove a file from the cache
+    static void Invalidate(const std::string &filename);
+    /// remove all files from the cache
+    static void Clear();
+
+    /// number of loads served from the cache
+    static size_t getHits();
+    /// number of files read
+    static size_t getMisses();
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_TABLECACHE_H */
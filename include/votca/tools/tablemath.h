@@ -0,0 +1,174 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_TABLEMATH_H
+#define	__VOTCA_TOOLS_TABLEMATH_H
+
+#include <stdexcept>
+#include <votca/tools/table.h>
+
+namespace votca { namespace tools {
+
+class CubicSpline;
+
+/**
+    \brief elementwise arithmetic and reductions on Tables
+
+    All operations work in place on the y column of a table, no temporary
+    tables are created. An entry is invalid if its flag is 'u' (or the old
+    TBL_INVALID). Binary operations require tables of the same size and mark
+    the result invalid where either operand is, log and division mark
+    entries they cannot compute. The loops run branch free over all entries,
+    so the values of invalid entries are unspecified afterwards (see
+    FillInvalid). Invalid entries are skipped by the reductions.
+
+    \code
+    // potential from rdf, U = -kT ln g + c
+    TableMath::BoltzmannInvert(rdf, kT);
+    TableMath::Scale(rdf, 1.0, -TableMath::Max(rdf));
+
+    // potential from force, U(r) = int_r^rc F dr
+    TableMath::Integrate(force, TableMath::Simpson);
+    TableMath::Scale(force, -1.0, force.y()[force.size() - 1]);
+    \endcode
+*/
+class TableMath
+{
+public:
+    /// flag written for entries which cannot be computed
+    static const char INVALID = 'u';
+
+    enum Integration {
+        /// trapezoidal rule, second order
+        Trapezoid,
+        /// piecewise quadratics through three neighbouring points, fourth
+        /// order on uniform grids
+        Simpson,
+        /// exact integral of the natural cubic spline through the points
+        Spline
+    };
+
+    static bool IsValid(char flag) { return flag != INVALID && flag != TBL_INVALID; }
+
+    /// y = a*y + b
+    static void Scale(Table &t, double a, double b = 0);
+    /// y += a*other.y
+    static void Axpy(Table &t, double a, const Table &other);
+    /// y += other.y
+    static void Add(Table &t, const Table &other) { Axpy(t, 1.0, other); }
+    /// y -= other.y
+    static void Subtract(Table &t, const Table &other) { Axpy(t, -1.0, other); }
+    /// y *= other.y
+    static void Multiply(Table &t, const Table &other);
+    /// y /= other.y, invalid where other.y is zero
+    static void Divide(Table &t, const Table &other);
+
+    /// y = ln y, invalid (and 0) where y <= 0
+    static void Log(Table &t);
+    /// y = exp(y)
+    static void Exp(Table &t);
+    /// y = -kT ln y, invalid (and 0) where y <= 0
+    static void BoltzmannInvert(Table &t, double kT);
+    /// y = exp(-y/kT), the inverse of BoltzmannInvert
+    static void Boltzmann(Table &t, double kT);
+
+    /// y = op(y) for all valid entries
+    template<typename op_t>
+    static void Transform(Table &t, op_t op);
+    /// y = op(y, other.y), invalid where either entry is
+    template<typename op_t>
+    static void Transform(Table &t, const Table &other, op_t op);
+
+    /// set all invalid entries to value, the flags are kept
+    static void FillInvalid(Table &t, double value);
+
+    /// number of valid entries
+    static int CountValid(const Table &t);
+    /// sum over valid entries
+    static double Sum(const Table &t);
+    /// mean of valid entries, throws if there are none
+    static double Mean(const Table &t);
+    /// smallest valid entry, throws if there are none
+    static double Min(const Table &t);
+    /// largest valid entry, throws if there are none
+    static double Max(const Table &t);
+    /// sum of a.y*b.y over entries valid in both
+    static double Dot(const Table &a, const Table &b);
+
+    /**
+     * \brief cumulative integral, y[i] = int_x[0]^x[i] y dx
+     *
+     * The grid may be non-uniform. Invalid entries are left out, the
+     * integration bridges them and they get the interpolated integral.
+     * Entries before the first valid one stay invalid and the integral
+     * starts there.
+     */
+    static void Integrate(Table &t, Integration method = Trapezoid);
+    /**
+     * \brief cumulative integral of a spline
+     * @param spline interpolated or fitted cubic spline
+     * @param out integral on the grid of the spline
+     */
+    static void Integrate(CubicSpline &spline, Table &out);
+    /**
+     * \brief derivative by finite differences
+     * @param deriv order of the derivative
+     * @param accuracy order of accuracy in the grid spacing
+     *
+     * Works on non-uniform grids (Fornberg weights), on uniform grids the
+     * weights are computed once. Interior points use centered stencils
+     * of deriv + accuracy points, on uniform grids the smallest symmetric
+     * stencil of odd size with that accuracy. The ends use
+     * one-sided stencils of the same accuracy. Entries whose stencil
+     * contains an invalid entry are marked invalid.
+     */
+    static void Derivative(Table &t, int deriv = 1, int accuracy = 4);
+
+private:
+    static void CheckSize(const Table &a, const Table &b);
+    // or the invalid flags of src into dst
+    static void MergeFlags(char *dst, const char *src, int n);
+};
+
+template<typename op_t>
+inline void TableMath::Transform(Table &t, op_t op)
+{
+    double *y = t.y().data().begin();
+    const char *f = t.flags().data().begin();
+    int n = t.size();
+    for(int i = 0; i < n; ++i)
+        if(IsValid(f[i]))
+            y[i] = op(y[i]);
+}
+
+template<typename op_t>
+inline void TableMath::Transform(Table &t, const Table &other, op_t op)
+{
+    CheckSize(t, other);
+    double *y = t.y().data().begin();
+    const double *o = other.y().data().begin();
+    int n = t.size();
+    MergeFlags(t.flags().data().begin(), other.flags().data().begin(), n);
+    const char *f = t.flags().data().begin();
+    for(int i = 0; i < n; ++i)
+        if(IsValid(f[i]))
+            y[i] = op(y[i], o[i]);
+}
+
+}}
+
+#endif	/* __VOTCA_TOOLS_TABLEMATH_H */
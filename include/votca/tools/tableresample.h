@@ -0,0 +1,110 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_TABLERESAMPLE_H
+#define	__VOTCA_TOOLS_TABLERESAMPLE_H
+
+#include <vector>
+#include <votca/tools/table.h>
+
+namespace votca { namespace tools {
+
+/**
+    \brief resample Tables onto a new grid
+
+    Both grids have to be increasing. The source interval of every target
+    point is found in one merge over the two grids, and the interpolation
+    weights are stored, so each table costs O(N + M) with no interval
+    search. The weights (and for cubic splines the factorized tridiagonal
+    system) are kept as long as the grids do not change, which makes
+    resampling many tables from the same grid cheap.
+
+    Cubic resampling uses the natural spline (f'' = 0 at the ends, as
+    CubicSpline with splineNormal), Akima resampling extends the end slopes
+    linearly. Invalid source entries split the table, every run of valid
+    entries gets its own spline with these end conditions, so invalid
+    values only affect the intervals next to them. Target points in such
+    an interval are flagged 'u'. Target points outside the source range
+    are extrapolated from the end interval and flagged 'o', all others 'i'.
+
+    \code
+    TableResample resample(TableResample::Cubic);
+    grid.GenerateGridSpacing(0, 1.2, 0.002);
+    resample.Resample(potentials, grid.x(), output);
+    \endcode
+*/
+class TableResample
+{
+public:
+    enum Method {
+        Linear,
+        Cubic,
+        Akima
+    };
+
+    TableResample(Method method = Cubic) : _method(method) {}
+
+    Method getMethod() const { return _method; }
+    void setMethod(Method method);
+
+    /**
+     * \brief resample a single table
+     * @param in source table, needs at least 2 points
+     * @param out result, its x column is the target grid
+     */
+    void Resample(const Table &in, Table &out);
+
+    /**
+     * \brief resample a single table onto a uniform grid
+     *
+     * The target grid is created by out.GenerateGridSpacing(min, max, step).
+     */
+    void Resample(const Table &in, Table &out, double min, double max, double step);
+
+    /**
+     * \brief resample many tables onto the same grid
+     * @param in source tables
+     * @param grid target grid
+     * @param out results, one per source table, resized to the grid
+     */
+    void Resample(const std::vector<Table *> &in, const ub::vector<double> &grid,
+        const std::vector<Table *> &out);
+
+private:
+    Method _method;
+
+    // grids the weights below were computed for
+    std::vector<double> _from, _to;
+    // left source point and the weights of y[k], y[k+1], d[k], d[k+1]
+    // for every target point, d is f'' for cubic and f' for akima splines
+    std::vector<int> _interval;
+    std::vector<double> _weights;
+    std::vector<char> _outside;
+    // factorized tridiagonal system of the natural spline
+    std::vector<double> _lower, _pivot;
+    // d for the current table
+    std::vector<double> _d;
+
+    void Prepare(const ub::vector<double> &from, const ub::vector<double> &to);
+    // d over the run of valid source points a..b
+    void SecondDerivatives(const double *y, int a, int b);
+    void AkimaSlopes(const double *y, int a, int b);
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_TABLERESAMPLE_H */
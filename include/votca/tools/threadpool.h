@@ -0,0 +1,137 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_THREADPOOL_H
+#define	__VOTCA_TOOLS_THREADPOOL_H
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <signal.h>
+#include <pthread.h>
+
+namespace votca { namespace tools {
+
+class PoolWorker;
+
+/**
+    \brief fixed set of worker threads processing a queue of jobs
+
+    Jobs are derived from ThreadPool::Job and submitted to the pool, the
+    workers pick them up in submission order:
+    \code
+    class MyJob : public ThreadPool::Job {
+        void Run() { ... }
+    };
+    ThreadPool pool(4);
+    for(...)
+        pool.Submit(new MyJob(...));
+    pool.Wait();
+    \endcode
+
+    SIGINT is blocked in the workers, so the signal is delivered to the
+    main thread. If an interrupt flag is set (see setInterruptFlag),
+    pending jobs are discarded once the flag becomes nonzero.
+*/
+class ThreadPool
+{
+public:
+    class Job {
+    public:
+        virtual ~Job() {}
+        virtual void Run() = 0;
+    };
+
+    /**
+     * \brief start the workers
+     * @param nthreads number of threads, 0 for one per processor
+     */
+    ThreadPool(int nthreads = 0);
+    /// waits for running jobs and stops the workers, pending jobs are discarded
+    ~ThreadPool();
+
+    /**
+     * \brief add a job to the queue
+     * @param job the job
+     * @param owned delete the job after it was run
+     */
+    void Submit(Job *job, bool owned = true);
+
+    /**
+     * \brief wait until all submitted jobs are done
+     *
+     * If a job threw an exception, the first error is rethrown as
+     * runtime_error after all jobs are done.
+     * \return false if the pool was interrupted
+     */
+    bool Wait();
+
+    /// discard all pending jobs, running jobs are finished
+    void Cancel();
+
+    /**
+     * \brief flag which cancels the pool if it becomes nonzero
+     *
+     * The flag is polled, so it can be set from a signal handler.
+     */
+    void setInterruptFlag(volatile sig_atomic_t *flag) { _interrupt = flag; }
+    bool Interrupted() const { return _interrupt && *_interrupt; }
+
+    /// number of worker threads
+    int size() const { return _workers.size(); }
+
+    /// number of jobs run by a worker
+    size_t getJobs(int thread) const;
+    /// time in seconds a worker spent running jobs
+    double getBusyTime(int thread) const;
+    /// time in seconds since the pool was started
+    double getElapsedTime() const;
+
+    /// number of processors available
+    static int Processors();
+
+private:
+    struct entry_t {
+        Job *_job;
+        bool _owned;
+    };
+
+    std::deque<entry_t> _queue;
+    std::vector<PoolWorker *> _workers;
+    pthread_mutex_t _mutex;
+    pthread_cond_t _job_available;
+    pthread_cond_t _done;
+    int _active;
+    bool _shutdown;
+    std::string _error;
+    volatile sig_atomic_t *_interrupt;
+    double _start;
+
+    /// called by the workers, returns false on shutdown
+    bool NextJob(entry_t &entry);
+    void JobDone(const entry_t &entry, const std::string &error);
+    void DiscardPending();
+
+    friend class PoolWorker;
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+};
+
+}}
+
+#endif	/* __VOTCA_TOOLS_THREADPOOL_H */
@@ -107,6 +107,60 @@ private:
 
 int wildcmp(const char *wild, const char *string);
 
+/**
+ * \brief compiled wildcard pattern
+ *
+ * Same matching rules as wildcmp ("*" matches any sequence, "?" any single
+ * character), but the pattern is analyzed once: literal prefix and suffix
+ * are compared directly and the parts between the stars are searched left
+ * to right, so no backtracking is needed. Use it when one pattern is
+ * matched against many names:
+ * \code
+ * WildcardMatcher m("bond_*_dist");
+ * for(...) if(m.Match(name)) ...
+ * \endcode
+ * Names in a sorted container can be restricted to the range starting with
+ * LiteralPrefix() before matching.
+ */
+class WildcardMatcher
+{
+public:
+    WildcardMatcher() { Compile(""); }
+    explicit WildcardMatcher(const std::string &pattern) { Compile(pattern); }
+
+    /// analyze a new pattern
+    void Compile(const std::string &pattern);
+
+    bool Match(const char *str, size_t len) const;
+    bool Match(const std::string &str) const { return Match(str.data(), str.size()); }
+    bool Match(const char *str) const;
+
+    /// the pattern as given
+    const std::string &Pattern() const { return _pattern; }
+    /// characters every match starts with, the pattern up to the first wildcard
+    const std::string &LiteralPrefix() const { return _literal_prefix; }
+    /// true if the pattern contains no wildcards
+    bool IsLiteral() const { return !_star && !_question; }
+
+private:
+    std::string _pattern;
+    std::string _literal_prefix;
+    /// pattern before the first and after the last star, can contain "?"
+    std::string _prefix;
+    std::string _suffix;
+    /// parts between stars
+    std::vector<std::string> _segments;
+    /// minimum length of a match
+    size_t _min_length;
+    bool _star;
+    bool _question;
+
+    /// compare a part of the pattern, "?" matches any character
+    bool Compare(const char *str, const std::string &part) const;
+    /// first position of part in [begin, end) or NULL
+    const char *Find(const char *begin, const char *end, const std::string &part) const;
+};
+
 }}
 
 #endif	/* _tools_H */
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_TOOLS_XMLREADER_H
+#define	__VOTCA_TOOLS_XMLREADER_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <stdexcept>
+#include <votca/tools/lexical_cast.h>
+
+namespace votca { namespace tools {
+
+class CompressedIFStream;
+
+/**
+ * \brief pull parser for XML files (wrapper for expat)
+ *
+ * In contrast to ParseXML, the reader is asked for the next event instead of
+ * calling handlers. The input is read in blocks and the parser is suspended
+ * after each event, so the memory used does not depend on the file size.
+ * Event data (name, attributes, text) stay valid until the next call to
+ * Next and reuse their storage, reading a million molecules does not
+ * allocate a million attribute maps:
+ * \code
+ * XMLReader xml("topol.xml");
+ * xml.NextElement();                        // root element
+ * int root = xml.Depth();
+ * while(xml.NextChild(root)) {
+ *     if(xml.Name() == "molecule") {
+ *         names.push_back(xml.getAttribute<string>("name"));
+ *         nbeads.push_back(xml.getAttribute<int>("nbeads", 0));
+ *     }
+ *     xml.SkipSubtree();
+ * }
+ * \endcode
+ * Compressed files are read transparently (see CompressedIFStream).
+ */
+class XMLReader
+{
+public:
+    enum EventType {
+        StartElement,
+        EndElement,
+        Text,
+        EndDocument
+    };
+
+    XMLReader();
+    /// open a file, see Open
+    XMLReader(const std::string &filename);
+    ~XMLReader();
+
+    /**
+     * \brief open a file for reading
+     * @param filename XML file, can be compressed
+     */
+    void Open(const std::string &filename);
+    /**
+     * \brief read from a stream
+     * @param in stream, must stay valid until the reader is closed
+     * @param name name used in error messages
+     */
+    void Open(std::istream &in, const std::string &name = "stream");
+    void Close();
+
+    /**
+     * \brief advance to the next event
+     * @return type of the event
+     *
+     * Consecutive character data are returned as one Text event. Text
+     * consisting of white space only is skipped unless disabled with
+     * setSkipWhitespace. Throws std::runtime_error on parse errors.
+     */
+    EventType Next();
+
+    /**
+     * \brief advance to the next start element
+     * @return false if the end of the document was reached
+     */
+    bool NextElement();
+
+    /**
+     * \brief advance to the next child of an element
+     * @param depth depth of the parent element
+     * @return true at the start of a child, false at the end of the parent
+     *
+     * The content of the previous child is passed over if it was not read,
+     * SkipSubtree does the same without storing the events.
+     */
+    bool NextChild(int depth);
+
+    /**
+     * \brief skip the content of the current element
+     *
+     * Must be called at a start element, afterwards the current event is
+     * the corresponding end element. Events inside the skipped element are
+     * not stored at all.
+     */
+    void SkipSubtree();
+
+    /**
+     * \brief read the text of the current element
+     * @return text of the element, child elements are skipped
+     *
+     * Must be called at a start element, afterwards the current event is
+     * the corresponding end element.
+     */
+    std::string ReadText();
+
+    /// type of the current event
+    EventType Type() const { return current()._type; }
+    /// element name of a start or end element
+    const std::string &Name() const { return current()._name; }
+    /// content of a text event
+    const std::string &Value() const { return current()._name; }
+    /// depth of the current element, the root element has depth 1
+    int Depth() const { return current()._depth; }
+    /// line of the current event in the input
+    int Line() const { return current()._line; }
+
+    /// number of attributes of the current start element
+    int AttributeCount() const { return current()._nattributes; }
+    /// name of the i-th attribute
+    const std::string &AttributeName(int i) const { return current()._attributes[i].first; }
+    /// value of the i-th attribute
+    const std::string &AttributeValue(int i) const { return current()._attributes[i].second; }
+    /// value of an attribute or NULL if it does not exist
+    const std::string *findAttribute(const std::string &name) const;
+    /// true if the current start element has an attribute
+    bool hasAttribute(const std::string &name) const { return findAttribute(name) != NULL; }
+    /**
+     * \brief return attribute as type
+     *
+     * Throws std::runtime_error if the attribute does not exist.
+     */
+    template<typename T>
+    T getAttribute(const std::string &name) const;
+    /// return attribute as type or a default if it does not exist
+    template<typename T>
+    T getAttribute(const std::string &name, const T &def) const;
+
+    /// skip text events consisting of white space only (default true)
+    void setSkipWhitespace(bool skip) { _skip_whitespace = skip; }
+
+private:
+    struct Event {
+        EventType _type;
+        /// element name or text
+        std::string _name;
+        /// attribute storage, only the first _nattributes are valid
+        std::vector<std::pair<std::string, std::string> > _attributes;
+        int _nattributes;
+        int _depth;
+        int _line;
+    };
+
+    const Event &current() const { return _events[_pos]; }
+    void Init(std::istream &in, const std::string &name);
+    Event &Push(EventType type);
+    /// parse more input until new events are available
+    void Feed();
+    void Error(const std::string &message);
+
+    static void StartHndl(void *data, const char *el, const char **attr);
+    static void EndHndl(void *data, const char *el);
+    static void CharHndl(void *data, const char *txt, int len);
+
+    void *_parser;
+    std::istream *_in;
+    CompressedIFStream *_file;
+    std::string _name;
+
+    /// queued events, reused between calls
+    std::vector<Event> _events;
+    size_t _pos;
+    size_t _count;
+
+    /// depth of the parser, can be ahead of the current event
+    int _parse_depth;
+    /// events deeper than this are dropped while skipping, 0 if not skipping
+    int _skip_depth;
+    bool _suspended;
+    bool _finished;
+    bool _skip_whitespace;
+
+    // owns the parser and the stream
+    XMLReader(const XMLReader &);
+    XMLReader &operator=(const XMLReader &);
+};
+
+template<typename T>
+inline T XMLReader::getAttribute(const std::string &name) const
+{
+    const std::string *value = findAttribute(name);
+    if(value == NULL)
+        throw std::runtime_error("attribute " + name + " not found in element " + Name());
+    return lexical_cast<T>(*value, "wrong type in attribute " + name + " of element " + Name() + "\n");
+}
+
+template<typename T>
+inline T XMLReader::getAttribute(const std::string &name, const T &def) const
+{
+    const std::string *value = findAttribute(name);
+    if(value == NULL)
+        return def;
+    return lexical_cast<T>(*value, "wrong type in attribute " + name + " of element " + Name() + "\n");
+}
+
+}}
+
+#endif	/* __VOTCA_TOOLS_XMLREADER_H */
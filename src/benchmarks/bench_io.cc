@@ -0,0 +1,58 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <votca/tools/compressedstream.h>
+#include <boost/lexical_cast.hpp>
+#include <stdexcept>
+#include "benchmark.h"
+
+namespace votca { namespace tools {
+
+static std::string temp_gzip_file()
+{
+    return "votca_benchmark_" + boost::lexical_cast<std::string>(getpid()) + ".gz";
+}
+
+// writes size MiB with 4 threads and reads them back, sizes at multiples
+// of the 1 MiB compression block check that no queued block is lost
+static void io_GzipWrite(BenchmarkState &state)
+{
+    std::string data(state.size() << 20, ' ');
+    for(size_t i=0; i<data.size(); ++i)
+        data[i] = 'a' + (i * 7919 + i / 4093) % 26;
+    std::string file = temp_gzip_file();
+    while(state.KeepRunning()) {
+        CompressedOFStream out(file, Compression::Gzip, 4);
+        out.write(data.data(), data.size());
+        out.close();
+    }
+
+    CompressedIFStream in(file);
+    std::string back((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    remove(file.c_str());
+    if(back != data)
+        throw std::runtime_error("gzip round trip returned "
+            + boost::lexical_cast<std::string>(back.size()) + " of "
+            + boost::lexical_cast<std::string>(data.size()) + " bytes");
+    state.SetItemsProcessed(state.iterations()*data.size());
+}
+REGISTER_BENCHMARK(io_GzipWrite, "1,2,3,4,5")
+
+}}
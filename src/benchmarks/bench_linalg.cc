@@ -0,0 +1,88 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/linalg.h>
+#include "benchmark.h"
+
+namespace votca { namespace tools {
+
+// diagonally dominant symmetric matrix, well conditioned for all solvers
+static void setup_system(ub::matrix<double> &A, ub::vector<double> &b, int n)
+{
+    A.resize(n, n);
+    b.resize(n);
+    for(int i=0; i<n; ++i) {
+        for(int j=0; j<n; ++j)
+            A(i,j) = 1./(1. + i + j);
+        A(i,i) += n;
+        b(i) = 1. + i%7;
+    }
+}
+
+static void solver_qrsolve(BenchmarkState &state)
+{
+    ub::matrix<double> A0, A;
+    ub::vector<double> b, x(state.size());
+    setup_system(A0, b, state.size());
+    while(state.KeepRunning()) {
+        A = A0; // the solver destroys A
+        linalg_qrsolve(x, A, b);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+REGISTER_BENCHMARK(solver_qrsolve, "50,200,500")
+
+static void solver_cholesky_solve(BenchmarkState &state)
+{
+    ub::matrix<double> A0, A;
+    ub::vector<double> b, x(state.size());
+    setup_system(A0, b, state.size());
+    while(state.KeepRunning()) {
+        A = A0;
+        linalg_cholesky_solve(x, A, b);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+REGISTER_BENCHMARK(solver_cholesky_solve, "50,200,500")
+
+static void solver_invert(BenchmarkState &state)
+{
+    ub::matrix<double> A0, A, V(state.size(), state.size());
+    ub::vector<double> b;
+    setup_system(A0, b, state.size());
+    while(state.KeepRunning()) {
+        A = A0;
+        linalg_invert(A, V);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+REGISTER_BENCHMARK(solver_invert, "50,200,500")
+
+static void solver_eigenvalues(BenchmarkState &state)
+{
+    ub::matrix<double> A0, A, V;
+    ub::vector<double> b, E;
+    setup_system(A0, b, state.size());
+    while(state.KeepRunning()) {
+        A = A0;
+        linalg_eigenvalues(A, E, V);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+REGISTER_BENCHMARK(solver_eigenvalues, "50,200,500")
+
+}}
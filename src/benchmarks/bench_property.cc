@@ -0,0 +1,101 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <fstream>
+#include <stdio.h>
+#include <unistd.h>
+#include <votca/tools/property.h>
+#include <votca/tools/tokenizer.h>
+#include <boost/lexical_cast.hpp>
+#include "benchmark.h"
+
+namespace votca { namespace tools {
+
+// options file with n interactions, each with a few settings
+static std::string write_options(int n)
+{
+    std::string file = "votca_benchmark_" + boost::lexical_cast<std::string>(getpid()) + ".xml";
+    std::ofstream out(file.c_str());
+    out << "<cg>\n";
+    for(int i=0; i<n; ++i) {
+        out << "  <non-bonded>\n"
+            << "    <name>A" << i << "-B</name>\n"
+            << "    <min>0</min>\n    <max>1.2</max>\n    <step>0.01</step>\n"
+            << "    <inverse help=\"settings\">\n"
+            << "      <do_potential>1</do_potential>\n"
+            << "      <post_update>smooth</post_update>\n"
+            << "    </inverse>\n"
+            << "  </non-bonded>\n";
+    }
+    out << "  <inverse><kBT>2.49</kBT><iterations_max>100</iterations_max></inverse>\n";
+    out << "</cg>\n";
+    return file;
+}
+
+static void property_load(BenchmarkState &state)
+{
+    std::string file = write_options(state.size());
+    while(state.KeepRunning()) {
+        Property p;
+        load_property_from_xml(p, file);
+        DoNotOptimize(p.size());
+    }
+    remove(file.c_str());
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(property_load, "10,1000,10000")
+
+static void property_get(BenchmarkState &state)
+{
+    std::string file = write_options(state.size());
+    Property p;
+    load_property_from_xml(p, file);
+    remove(file.c_str());
+    while(state.KeepRunning())
+        DoNotOptimize(p.get("cg.inverse.kBT").as<double>());
+    state.SetItemsProcessed(state.iterations());
+}
+REGISTER_BENCHMARK(property_get, "10,1000,10000")
+
+static void property_Select(BenchmarkState &state)
+{
+    std::string file = write_options(state.size());
+    Property p;
+    load_property_from_xml(p, file);
+    remove(file.c_str());
+    while(state.KeepRunning())
+        DoNotOptimize(p.Select("cg.non-bonded.inverse.do_potential").size());
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(property_Select, "10,1000,10000")
+
+static void tokenizer_ConvertToVector(BenchmarkState &state)
+{
+    std::string line;
+    for(int i=0; i<state.size(); ++i)
+        line += boost::lexical_cast<std::string>(0.5*i) + " ";
+    std::vector<double> v;
+    while(state.KeepRunning()) {
+        Tokenizer tok(line, " \t");
+        v.clear();
+        tok.ConvertToVector(v);
+    }
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(tokenizer_ConvertToVector, "3,100,10000")
+
+}}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cmath>
+#include <votca/tools/cubicspline.h>
+#include "benchmark.h"
+
+namespace votca { namespace tools {
+
+// grid with n points on [0,10] and sin(x) as values, f'' set directly so
+// that no linear solver is needed for the setup
+static void setup_spline(CubicSpline &spline, int n)
+{
+    spline.GenerateGrid(0., 10., 10./(n-1));
+    ub::vector<double> f(spline.getX().size()), f2(spline.getX().size());
+    for(size_t i=0; i<f.size(); ++i) {
+        f(i) = sin(spline.getX()(i));
+        f2(i) = -f(i);
+    }
+    spline.setSplineData(f, f2);
+}
+
+// pseudo random points in [0,10], same sequence for every run
+static void lookup_points(std::vector<double> &x, int n)
+{
+    x.resize(n);
+    unsigned int seed = 12345;
+    for(int i=0; i<n; ++i) {
+        seed = seed*1103515245 + 12345;
+        x[i] = 10.*((seed>>8) & 0xffff)/65536.;
+    }
+}
+
+static void spline_getInterval(BenchmarkState &state)
+{
+    CubicSpline spline;
+    setup_spline(spline, state.size());
+    std::vector<double> x;
+    lookup_points(x, 1024);
+    while(state.KeepRunning())
+        for(size_t i=0; i<x.size(); ++i)
+            DoNotOptimize(spline.getInterval(x[i]));
+    state.SetItemsProcessed(state.iterations()*x.size());
+}
+REGISTER_BENCHMARK(spline_getInterval, "16,128,1024,8192")
+
+static void cubicspline_Calculate(BenchmarkState &state)
+{
+    CubicSpline spline;
+    setup_spline(spline, state.size());
+    std::vector<double> x;
+    lookup_points(x, 1024);
+    while(state.KeepRunning())
+        for(size_t i=0; i<x.size(); ++i)
+            DoNotOptimize(spline.Calculate(x[i]));
+    state.SetItemsProcessed(state.iterations()*x.size());
+}
+REGISTER_BENCHMARK(cubicspline_Calculate, "16,128,1024,8192")
+
+static void cubicspline_Interpolate(BenchmarkState &state)
+{
+    ub::vector<double> x(state.size()), y(state.size());
+    for(int i=0; i<state.size(); ++i) {
+        x(i) = 10.*i/(state.size()-1);
+        y(i) = sin(x(i));
+    }
+    CubicSpline spline;
+    while(state.KeepRunning())
+        spline.Interpolate(x, y);
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(cubicspline_Interpolate, "32,128,512")
+
+static void cubicspline_Fit(BenchmarkState &state)
+{
+    // fit 10 noisy data points per grid point
+    int ndata = 10*state.size();
+    ub::vector<double> x(ndata), y(ndata);
+    std::vector<double> noise;
+    lookup_points(noise, ndata);
+    for(int i=0; i<ndata; ++i) {
+        x(i) = 10.*i/(ndata-1);
+        y(i) = sin(x(i)) + 0.01*(noise[i] - 5.);
+    }
+    CubicSpline spline;
+    while(state.KeepRunning()) {
+        spline.GenerateGrid(0., 10., 10./(state.size()-1));
+        spline.Fit(x, y);
+    }
+    state.SetItemsProcessed(state.iterations()*ndata);
+}
+REGISTER_BENCHMARK(cubicspline_Fit, "16,64,128")
+
+}}
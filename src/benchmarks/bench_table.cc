@@ -0,0 +1,187 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cmath>
+#include <stdio.h>
+#include <unistd.h>
+#include <votca/tools/table.h>
+#include <votca/tools/tablemath.h>
+#include <votca/tools/tableresample.h>
+#include <votca/tools/histogram.h>
+#include <votca/tools/histogramnew.h>
+#include <votca/tools/crosscorrelate.h>
+#include <votca/tools/datacollection.h>
+#include <boost/lexical_cast.hpp>
+#include "benchmark.h"
+
+namespace votca { namespace tools {
+
+static std::string temp_table_file()
+{
+    return "votca_benchmark_" + boost::lexical_cast<std::string>(getpid()) + ".tab";
+}
+
+static void fill_table(Table &t, int n)
+{
+    t.resize(n);
+    for(int i=0; i<n; ++i)
+        t.set(i, 0.01*i, exp(-0.01*i), 'i');
+}
+
+static void table_Save(BenchmarkState &state)
+{
+    Table t;
+    fill_table(t, state.size());
+    std::string file = temp_table_file();
+    while(state.KeepRunning())
+        t.Save(file);
+    remove(file.c_str());
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(table_Save, "1000,100000")
+
+static void table_Load(BenchmarkState &state)
+{
+    Table t;
+    fill_table(t, state.size());
+    std::string file = temp_table_file();
+    t.Save(file);
+    while(state.KeepRunning()) {
+        Table in;
+        in.Load(file);
+        DoNotOptimize(in.size());
+    }
+    remove(file.c_str());
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(table_Load, "1000,100000")
+
+static void table_Smooth(BenchmarkState &state)
+{
+    Table t;
+    fill_table(t, state.size());
+    while(state.KeepRunning())
+        t.Smooth(100);
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(table_Smooth, "1000,100000")
+
+static void table_SmoothBinomial(BenchmarkState &state)
+{
+    Table t;
+    fill_table(t, state.size());
+    while(state.KeepRunning())
+        t.SmoothBinomial(100);
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(table_SmoothBinomial, "1000,100000")
+
+static void table_BoltzmannInvert(BenchmarkState &state)
+{
+    Table rdf, t;
+    fill_table(rdf, state.size());
+    t.resize(state.size());
+    while(state.KeepRunning()) {
+        t.y() = rdf.y();
+        t.flags() = rdf.flags();
+        TableMath::BoltzmannInvert(t, 2.49);
+        TableMath::Scale(t, 1.0, -TableMath::Max(t));
+    }
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(table_BoltzmannInvert, "1000,100000")
+
+static void table_Resample(BenchmarkState &state)
+{
+    Table in, out;
+    fill_table(in, state.size());
+    out.GenerateGridSpacing(0, 0.01*state.size(), 0.003);
+    TableResample resample(TableResample::Cubic);
+    while(state.KeepRunning())
+        resample.Resample(in, out);
+    state.SetItemsProcessed(state.iterations()*out.size());
+}
+REGISTER_BENCHMARK(table_Resample, "1000,100000")
+
+static void table_IntegrateDerivative(BenchmarkState &state)
+{
+    Table t;
+    fill_table(t, state.size());
+    while(state.KeepRunning()) {
+        TableMath::Integrate(t, TableMath::Simpson);
+        TableMath::Derivative(t, 1, 4);
+    }
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(table_IntegrateDerivative, "1000,100000")
+
+// gaussian like distributed values
+template<typename V>
+static void fill_data(V &v, int n)
+{
+    v.resize(n);
+    unsigned int seed = 4711;
+    for(int i=0; i<n; ++i) {
+        double s = 0;
+        for(int j=0; j<4; ++j) {
+            seed = seed*1103515245 + 12345;
+            s += ((seed>>8) & 0xffff)/65536.;
+        }
+        v[i] = s;
+    }
+}
+
+static void histogram_ProcessData(BenchmarkState &state)
+{
+    DataCollection<double> data;
+    DataCollection<double>::array *a = data.CreateArray("values");
+    fill_data(*a, state.size());
+    DataCollection<double>::selection *sel = data.select("values");
+    Histogram::options_t op;
+    op._n = 101;
+    Histogram h(op);
+    while(state.KeepRunning())
+        h.ProcessData(sel);
+    delete sel;
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(histogram_ProcessData, "10000,1000000")
+
+static void histogramnew_ProcessRange(BenchmarkState &state)
+{
+    std::vector<double> v;
+    fill_data(v, state.size());
+    HistogramNew h;
+    h.Initialize(0., 4., 100);
+    while(state.KeepRunning())
+        h.ProcessRange(v.begin(), v.end());
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(histogramnew_ProcessRange, "10000,1000000")
+
+static void crosscorrelate_AutoCorr(BenchmarkState &state)
+{
+    std::vector<double> v;
+    fill_data(v, state.size());
+    CrossCorrelate c;
+    while(state.KeepRunning())
+        c.AutoCorr(v);
+    state.SetItemsProcessed(state.iterations()*state.size());
+}
+REGISTER_BENCHMARK(crosscorrelate_AutoCorr, "1024,65536,1000000")
+
+}}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "benchmark.h"
+#include <votca/tools/profiler.h>
+#include <votca/tools/tokenizer.h>
+#include <votca/tools/version.h>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/replace.hpp>
+#include <stdexcept>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+BenchmarkState::BenchmarkState(int size, double min_time)
+    : _size(size), _min_time(min_time), _running(false), _iterations(0),
+      _batch(1), _remaining(0), _start(0), _elapsed(0), _items(0)
+{}
+
+bool BenchmarkState::KeepRunning()
+{
+    // only look at the clock after a batch of iterations, reading the
+    // clock would dominate for very short benchmarks
+    if(_remaining > 0) {
+        --_remaining;
+        ++_iterations;
+        return true;
+    }
+
+    double now = Profiler::Now();
+    if(!_running) {
+        _running = true;
+        _start = now;
+    }
+    else {
+        _elapsed = now - _start;
+        if(_elapsed >= _min_time)
+            return false;
+        if(_batch < (1L<<20))
+            _batch *= 2;
+    }
+    _remaining = _batch - 1;
+    ++_iterations;
+    return true;
+}
+
+BenchmarkRegistry &BenchmarkRegistry::Instance()
+{
+    static BenchmarkRegistry _this;
+    return _this;
+}
+
+void BenchmarkRegistry::Register(const string &name, benchmark_t function, const string &sizes)
+{
+    entry_t entry;
+    entry._name = name;
+    entry._function = function;
+    Tokenizer tok(sizes, ", ");
+    tok.ConvertToVector<int>(entry._sizes);
+    if(entry._sizes.empty())
+        entry._sizes.push_back(0);
+    _benchmarks.push_back(entry);
+}
+
+vector<BenchmarkResult> BenchmarkRegistry::Run(const string &filter, double min_time, ostream *log)
+{
+    vector<BenchmarkResult> results;
+    for(size_t i=0; i<_benchmarks.size(); ++i) {
+        entry_t &b = _benchmarks[i];
+        if(!wildcmp(filter.c_str(), b._name.c_str()))
+            continue;
+        for(size_t j=0; j<b._sizes.size(); ++j) {
+            BenchmarkResult r;
+            r._name = b._name;
+            r._size = b._sizes[j];
+            r._skipped = false;
+            r._iterations = 0;
+            r._time = 0;
+            r._items_per_second = 0;
+
+            if(log) *log << b._name << "/" << r._size << "... " << flush;
+            BenchmarkState state(r._size, min_time);
+            try {
+                b._function(state);
+                r._iterations = state.iterations();
+                if(state.iterations() > 0)
+                    r._time = 1e9*state.elapsed()/state.iterations();
+                if(state.elapsed() > 0)
+                    r._items_per_second = state.items()/state.elapsed();
+            }
+            catch(std::exception &err) {
+                r._skipped = true;
+                r._message = err.what();
+            }
+            if(log) {
+                if(r._skipped) *log << "skipped (" << r._message << ")\n";
+                else *log << "done\n";
+            }
+            results.push_back(r);
+        }
+    }
+    return results;
+}
+
+void WriteBenchmarksText(ostream &out, const vector<BenchmarkResult> &results)
+{
+    out << boost::format("%-40s %15s %12s %15s\n") % "benchmark" % "time [ns]" % "iterations" % "items/s";
+    for(size_t i=0; i<results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        string name = r._name + "/" + boost::lexical_cast<string>(r._size);
+        if(r._skipped)
+            out << boost::format("%-40s %15s\n") % name % "skipped";
+        else
+            out << boost::format("%-40s %15.1f %12d %15.4g\n") % name % r._time % r._iterations % r._items_per_second;
+    }
+}
+
+void WriteBenchmarksCSV(ostream &out, const vector<BenchmarkResult> &results)
+{
+    out << "name,size,iterations,real_time_ns,items_per_second,skipped\n";
+    for(size_t i=0; i<results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        out << r._name << "," << r._size << "," << r._iterations << ","
+            << r._time << "," << r._items_per_second << "," << (r._skipped ? 1 : 0) << "\n";
+    }
+}
+
+void WriteBenchmarksJSON(ostream &out, const vector<BenchmarkResult> &results)
+{
+    out.precision(10);
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"library\": \"votca_tools\",\n";
+    out << "    \"version\": \"" << ToolsVersionStr() << "\"\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [";
+    for(size_t i=0; i<results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        out << (i ? ",\n" : "\n");
+        out << "    {\n";
+        out << "      \"name\": \"" << r._name << "/" << r._size << "\",\n";
+        out << "      \"size\": " << r._size << ",\n";
+        if(r._skipped) {
+            string msg = r._message;
+            boost::replace_all(msg, "\\", "\\\\");
+            boost::replace_all(msg, "\"", "\\\"");
+            boost::replace_all(msg, "\n", " ");
+            out << "      \"skipped\": true,\n";
+            out << "      \"error_message\": \"" << msg << "\"\n";
+        }
+        else {
+            out << "      \"iterations\": " << r._iterations << ",\n";
+            out << "      \"real_time\": " << r._time << ",\n";
+            out << "      \"time_unit\": \"ns\",\n";
+            out << "      \"items_per_second\": " << r._items_per_second << "\n";
+        }
+        out << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+}}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __VOTCA_BENCHMARK_H
+#define	__VOTCA_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace votca { namespace tools {
+
+/**
+    The REGISTER_BENCHMARK macro registers a benchmark function for a list of
+    problem sizes, e.g. REGISTER_BENCHMARK(spline_calculate, "100,1000,10000")
+ */
+#define REGISTER_BENCHMARK(function, sizes) \
+    namespace { \
+        BenchmarkRegister _register_##function(#function, function, sizes); \
+    }
+
+/**
+ * \brief state of a running benchmark
+ *
+ * A benchmark function does its setup, then calls KeepRunning in a loop
+ * around the code to be timed:
+ * \code
+ * void table_smooth(BenchmarkState &state)
+ * {
+ *     Table t; ... // setup for state.size() points
+ *     while(state.KeepRunning())
+ *         t.Smooth(1);
+ *     state.SetItemsProcessed(state.iterations()*state.size());
+ * }
+ * \endcode
+ * The number of iterations is increased until the loop ran for at least
+ * the minimum time. If a benchmark cannot run (e.g. a library was not
+ * compiled in), throwing an exception marks it as skipped.
+ */
+class BenchmarkState
+{
+public:
+    BenchmarkState(int size, double min_time);
+
+    /// true as long as more iterations are needed
+    bool KeepRunning();
+
+    /// problem size of this run
+    int size() const { return _size; }
+    /// number of iterations done so far
+    long iterations() const { return _iterations; }
+    /// time of all iterations in seconds
+    double elapsed() const { return _elapsed; }
+
+    /// number of processed items (points, lines, ...) for the throughput
+    void SetItemsProcessed(long items) { _items = items; }
+    long items() const { return _items; }
+
+private:
+    int _size;
+    double _min_time;
+    bool _running;
+    long _iterations;
+    long _batch;
+    long _remaining;
+    double _start;
+    double _elapsed;
+    long _items;
+};
+
+typedef void (*benchmark_t)(BenchmarkState &);
+
+/// result of one benchmark run for one size
+struct BenchmarkResult {
+    std::string _name;
+    int _size;
+    long _iterations;
+    /// time per iteration in nano seconds
+    double _time;
+    double _items_per_second;
+    bool _skipped;
+    std::string _message;
+};
+
+/**
+ * \brief list of all registered benchmarks
+ */
+class BenchmarkRegistry
+{
+public:
+    struct entry_t {
+        std::string _name;
+        benchmark_t _function;
+        std::vector<int> _sizes;
+    };
+
+    static BenchmarkRegistry &Instance();
+
+    void Register(const std::string &name, benchmark_t function, const std::string &sizes);
+
+    /**
+     * \brief run all benchmarks matching a wildcard filter
+     * @param filter wildcard pattern for benchmark names
+     * @param min_time minimum run time per benchmark and size in seconds
+     * @param log progress output, may be NULL
+     */
+    std::vector<BenchmarkResult> Run(const std::string &filter, double min_time, std::ostream *log);
+
+    const std::vector<entry_t> &getBenchmarks() { return _benchmarks; }
+
+private:
+    std::vector<entry_t> _benchmarks;
+};
+
+class BenchmarkRegister {
+public:
+    BenchmarkRegister(const char *name, benchmark_t function, const char *sizes) {
+        BenchmarkRegistry::Instance().Register(name, function, sizes);
+    }
+};
+
+/// write results as human readable table
+void WriteBenchmarksText(std::ostream &out, const std::vector<BenchmarkResult> &results);
+/// write results as json (layout similar to google benchmark)
+void WriteBenchmarksJSON(std::ostream &out, const std::vector<BenchmarkResult> &results);
+/// write results as csv
+void WriteBenchmarksCSV(std::ostream &out, const std::vector<BenchmarkResult> &results);
+
+/// prevents the compiler from optimizing away a result
+template<typename T>
+inline void DoNotOptimize(const T &value)
+{
+    asm volatile("" : : "g"(value) : "memory");
+}
+
+}}
+
+#endif	/* __VOTCA_BENCHMARK_H */
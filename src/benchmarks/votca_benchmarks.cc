@@ -0,0 +1,90 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <votca/tools/application.h>
+#include "benchmark.h"
+
+using namespace std;
+using namespace votca::tools;
+namespace po = boost::program_options;
+
+class VotcaBenchmarks : public Application {
+
+public:
+    string ProgramName()  { return "votca_benchmarks"; }
+
+    void HelpText(ostream &out) {
+        out << "Runs the benchmark suite of votca_tools.\n"
+               "Results can be written as json or csv to compare releases.";
+    }
+
+    void Initialize() {
+        AddProgramOptions()
+        ("filter", po::value<string>()->default_value("*"), "  run only benchmarks matching this wildcard")
+        ("min-time", po::value<double>()->default_value(0.2), "  minimum time per benchmark and size in seconds")
+        ("format", po::value<string>()->default_value("text"), "  output format [text json csv]")
+        ("out", po::value<string>(), "  write results to file instead of stdout")
+        ("list", "  list available benchmarks");
+    }
+
+    bool EvaluateOptions() {
+        string format = _op_vm["format"].as<string>();
+        if(format != "text" && format != "json" && format != "csv")
+            throw runtime_error("unknown format " + format);
+        return true;
+    }
+
+    void Run() {
+        BenchmarkRegistry &registry = BenchmarkRegistry::Instance();
+
+        if(_op_vm.count("list")) {
+            const vector<BenchmarkRegistry::entry_t> &b = registry.getBenchmarks();
+            for(size_t i=0; i<b.size(); ++i)
+                cout << b[i]._name << endl;
+            return;
+        }
+
+        vector<BenchmarkResult> results = registry.Run(_op_vm["filter"].as<string>(),
+                _op_vm["min-time"].as<double>(), &cerr);
+
+        ofstream fl;
+        ostream *out = &cout;
+        if(_op_vm.count("out")) {
+            fl.open(_op_vm["out"].as<string>().c_str());
+            if(!fl)
+                throw runtime_error("cannot open " + _op_vm["out"].as<string>());
+            out = &fl;
+        }
+
+        string format = _op_vm["format"].as<string>();
+        if(format == "json")
+            WriteBenchmarksJSON(*out, results);
+        else if(format == "csv")
+            WriteBenchmarksCSV(*out, results);
+        else
+            WriteBenchmarksText(*out, results);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    VotcaBenchmarks bm;
+    return bm.Exec(argc, argv);
+}
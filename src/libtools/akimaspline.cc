@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/akimaspline.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
@@ -28,6 +29,8 @@ using namespace std;
 
 void AkimaSpline::Interpolate(ub::vector<double> &x, ub::vector<double> &y)
 {    
+    ScopedTimer timer("AkimaSpline::Interpolate");
+
     if(x.size() != y.size())
         throw std::invalid_argument("error in AkimaSpline::Interpolate : sizes of vectors x and y do not match");
     
@@ -143,6 +146,8 @@ void AkimaSpline::Interpolate(ub::vector<double> &x, ub::vector<double> &y)
 
 void AkimaSpline::Fit(ub::vector<double> &x, ub::vector<double> &y)
 {
+    ScopedTimer timer("AkimaSpline::Fit");
+
     throw std::runtime_error("Akima fit not implemented.");
 }
 
@@ -20,15 +20,45 @@
 #include <votca/tools/version.h>
 #include <votca/tools/globals.h>
 #include <votca/tools/propertyiomanipulator.h>
+#include <votca/tools/profiler.h>
+#include <votca/tools/memstat.h>
+#include <votca/tools/threadpool.h>
 
 #include <boost/format.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <signal.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
 
 namespace votca { namespace tools {
 
+// set by the SIGINT handler of ExecThreaded
+static volatile sig_atomic_t interrupted = 0;
+
+static void sigint_handler(int sig)
+{
+    if(interrupted) {
+        // second interrupt, give up
+        signal(sig, SIG_DFL);
+        raise(sig);
+        return;
+    }
+    interrupted = 1;
+    const char msg[] = "\ninterrupted, finishing running jobs (interrupt again to abort)\n";
+    if(write(STDERR_FILENO, msg, sizeof(msg)-1)) {}
+}
+
 Application::Application()
-    : _op_desc("Allowed options"), _continue_execution(true)
+    : _op_desc("Allowed options"), _continue_execution(true), _pool(NULL)
 {
 }
 
@@ -109,49 +139,303 @@ void Application::ShowTEXPage(std::ostream &out) {
 }
 
 int Application::Exec(int argc, char **argv)
+{
+    return Execute(argc, argv, false);
+}
+
+int Application::ExecThreaded(int argc, char **argv)
+{
+    return Execute(argc, argv, true);
+}
+
+bool Application::Interrupted()
+{
+    return interrupted != 0;
+}
+
+ThreadPool &Application::Pool()
+{
+    if(!_pool)
+        throw std::runtime_error("Application::Pool is only available in RunThreaded");
+    return *_pool;
+}
+
+int Application::Execute(int argc, char **argv, bool threaded)
 {
     try {
         //_continue_execution = true;
 	AddProgramOptions()("help,h", "  display this help and exit");
 	AddProgramOptions()("verbose,v", "  be loud and noisy");
+	AddProgramOptions()("profile", "  print a timing profile at the end of the run");
+	AddProgramOptions()("perf", "  like --profile, but also sample hardware counters");
+	AddProgramOptions()("memstat", "  print memory usage statistics at the end of the run");
+	if(threaded)
+	    AddProgramOptions()("nthreads", boost::program_options::value<int>()->default_value(0),
+	        "  number of threads, 0 for one per processor");
+	AddProgramOptions()("batch", "  read command lines of jobs from stdin and run them in this process");
+	AddProgramOptions()("socket", boost::program_options::value<string>(),
+	    "  like --batch, but read the jobs from connections to this UNIX socket");
 	AddProgramOptions("Hidden")("man", "  output man-formatted manual pages");
 	AddProgramOptions("Hidden")("tex", "  output tex-formatted manual pages");
 	
 	Initialize(); // initialize program-specific parameters
 
+        SetupOptions();
         ParseCommandLine(argc, argv); // initialize general parameters & read input file
 
-        if (_op_vm.count("verbose")) {
-	  globals::verbose = true;
+        if (_op_vm.count("socket"))
+            return RunSocket(_op_vm["socket"].as<string>(), threaded);
+        if (_op_vm.count("batch"))
+            return RunBatch(cin, threaded);
+
+        return RunJob(threaded);
+    }
+    catch(std::exception &error) {
+         cerr << "an error occurred:\n" << error.what() << endl;
+         return -1;
+    }
+    return 0;
+}
+
+int Application::RunJob(bool threaded)
+{
+    int retval = 0;
+    if (_op_vm.count("verbose")) {
+        globals::verbose = true;
+    }
+
+    if (_op_vm.count("profile") || _op_vm.count("perf")) {
+        Profiler::Enable();
+    }
+    if (_op_vm.count("perf")) {
+        Profiler::EnableCounters();
+    }
+    
+    if (_op_vm.count("man")) {
+        ShowManPage(cout);
+        return 0;
+    }
+    
+    if (_op_vm.count("tex")) {
+        ShowTEXPage(cout);
+        return 0;
+    }
+    
+    if (_op_vm.count("help")) {
+        ShowHelpText(cout);
+        return 0;
+    }
+
+    if(!EvaluateOptions()) {
+        ShowHelpText(cout);
+        return -1;
+    }
+
+    if(_continue_execution) {
+        if(threaded) {
+            retval = RunWithPool();
         }
-        
-        if (_op_vm.count("man")) {
-            ShowManPage(cout);
-            return 0;
+        else {
+            ScopedTimer timer("Application::Run");
+            Run();
         }
-        
-        if (_op_vm.count("tex")) {
-            ShowTEXPage(cout);
-            return 0;
+        if(Profiler::IsEnabled())
+            Profiler::Report(cout);
+        if(_op_vm.count("memstat"))
+            MemStat::Report(cout);
+    }
+    else cout << "nothing to be done - stopping here\n";
+
+    return retval;
+}
+
+int Application::RunBatchJob(const string &line, bool threaded)
+{
+    namespace po = boost::program_options;
+
+    // reset the state left by the previous job
+    globals::verbose = false;
+    _continue_execution = true;
+    Profiler::Clear();
+    Profiler::Enable(false);
+    Profiler::EnableCounters(false);
+
+    int retval;
+    try {
+        vector<string> args = po::split_unix(line);
+        vector<char *> argv;
+        string name = ProgramName();
+        argv.push_back(&name[0]);
+        for(size_t i=0; i<args.size(); ++i)
+            argv.push_back(&args[i][0]);
+        argv.push_back(NULL);
+
+        ParseCommandLine(argv.size() - 1, &argv[0]);
+        if(_op_vm.count("batch") || _op_vm.count("socket"))
+            throw runtime_error("--batch and --socket cannot be used in a batch job");
+        retval = RunJob(threaded);
+    }
+    catch(std::exception &error) {
+        cerr << "an error occurred:\n" << error.what() << endl;
+        retval = -1;
+    }
+    cout << flush;
+
+    try {
+        ResetJob();
+    }
+    catch(std::exception &error) {
+        cerr << "an error occurred while resetting the job:\n" << error.what() << endl;
+        retval = -1;
+    }
+    return retval;
+}
+
+int Application::RunBatch(istream &in, bool threaded)
+{
+    string line;
+    int retval = 0;
+    while(getline(in, line)) {
+        boost::trim(line);
+        if(line.empty() || line[0] == '#') continue;
+        if(line == "exit" || line == "quit") break;
+        if(RunBatchJob(line, threaded) != 0)
+            retval = -1;
+    }
+    return retval;
+}
+
+int Application::RunSocket(const string path, bool threaded)
+{
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server < 0)
+        throw runtime_error("cannot create socket");
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(addr.sun_path)) {
+        close(server);
+        throw runtime_error("socket path too long: " + path);
+    }
+    strcpy(addr.sun_path, path.c_str());
+    // remove a stale socket of an earlier run, but nothing else
+    struct stat st;
+    if(lstat(path.c_str(), &st) == 0) {
+        if(!S_ISSOCK(st.st_mode)) {
+            close(server);
+            throw runtime_error("cannot listen on socket " + path + ": file exists and is not a socket");
         }
-        
-        if (_op_vm.count("help")) {
-            ShowHelpText(cout);
-            return 0;
+        unlink(path.c_str());
+    }
+    if(bind(server, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(server, 16) != 0) {
+        close(server);
+        throw runtime_error("cannot listen on socket " + path + ": " + strerror(errno));
+    }
+
+    // a client which disconnects early must not kill the server
+    struct sigaction action, old_action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_IGN;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPIPE, &action, &old_action);
+
+    try {
+        ServeSocket(server, threaded);
+    }
+    catch(...) {
+        sigaction(SIGPIPE, &old_action, NULL);
+        close(server);
+        unlink(path.c_str());
+        throw;
+    }
+    sigaction(SIGPIPE, &old_action, NULL);
+
+    close(server);
+    unlink(path.c_str());
+    return 0;
+}
+
+void Application::ServeSocket(int server, bool threaded)
+{
+    namespace io = boost::iostreams;
+
+    bool shutdown = false;
+    while(!shutdown) {
+        int client = accept(server, NULL, NULL);
+        if(client < 0) {
+            if(errno == EINTR) continue;
+            break;
         }
 
-        if(!EvaluateOptions()) {
-            ShowHelpText(cout);
-            return -1;
+        // the output of the jobs goes to the client
+        io::stream<io::file_descriptor_source> in(client, io::never_close_handle);
+        io::stream<io::file_descriptor_sink> connection(client, io::never_close_handle);
+        streambuf *cout_buf = cout.rdbuf(connection.rdbuf());
+        streambuf *cerr_buf = cerr.rdbuf(connection.rdbuf());
+
+        string line;
+        while(getline(in, line)) {
+            boost::trim(line);
+            if(line.empty() || line[0] == '#') continue;
+            if(line == "exit" || line == "quit") break;
+            if(line == "shutdown") {
+                shutdown = true;
+                break;
+            }
+            int retval = RunBatchJob(line, threaded);
+            // tell the client that the job is done
+            connection << "# exit " << retval << endl;
         }
 
-        if(_continue_execution)
-            Run();
-	else cout << "nothing to be done - stopping here\n";
+        connection.flush();
+        cout.rdbuf(cout_buf);
+        cerr.rdbuf(cerr_buf);
+        close(client);
     }
-    catch(std::exception &error) {
-         cerr << "an error occurred:\n" << error.what() << endl;
-         return -1;
+}
+
+int Application::RunWithPool()
+{
+    boost::scoped_ptr<ThreadPool> pool(new ThreadPool(_op_vm["nthreads"].as<int>()));
+
+    struct sigaction action, old_action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = sigint_handler;
+    sigemptyset(&action.sa_mask);
+    interrupted = 0;
+    sigaction(SIGINT, &action, &old_action);
+
+    pool->setInterruptFlag(&interrupted);
+    _pool = pool.get();
+    try {
+        {
+            ScopedTimer timer("Application::RunThreaded");
+            RunThreaded();
+        }
+        _pool->Wait();
+    }
+    catch(...) {
+        _pool = NULL;
+        sigaction(SIGINT, &old_action, NULL);
+        throw;
+    }
+    _pool = NULL;
+
+    if(globals::verbose) {
+        double elapsed = pool->getElapsedTime();
+        cout << boost::format("%-8s %10s %12s %8s\n") % "thread" % "jobs" % "busy [s]" % "load";
+        for(int i=0; i<pool->size(); ++i)
+            cout << boost::format("%-8d %10d %12.3f %7.1f%%\n") % i % pool->getJobs(i)
+                % pool->getBusyTime(i) % (elapsed > 0 ? 100.*pool->getBusyTime(i)/elapsed : 0.);
+    }
+    // stop the workers before restoring the signal handler
+    pool.reset();
+    sigaction(SIGINT, &old_action, NULL);
+
+    if(interrupted) {
+        OnInterrupt();
+        cerr << "run was interrupted, results are incomplete\n";
+        return 130;
     }
     return 0;
 }
@@ -176,10 +460,8 @@ boost::program_options::options_description_easy_init
 }
 
 
-void Application::ParseCommandLine(int argc, char **argv)
+void Application::SetupOptions()
 {
-    namespace po = boost::program_options;
-
     std::map<string, boost::program_options::options_description>::iterator iter;
     
     // default options should be added to visible (the rest is handled via a map))
@@ -190,13 +472,19 @@ void Application::ParseCommandLine(int argc, char **argv)
         _op_desc.add(iter->second);
         if ( iter->first != "Hidden" ) _visible_options.add(iter->second);
     }
-    
+}
+
+void Application::ParseCommandLine(int argc, char **argv)
+{
+    namespace po = boost::program_options;
+
     // parse the command line
+    _op_vm.clear();
     try {
         po::store(po::parse_command_line(argc, argv, _op_desc), _op_vm);
         po::notify(_op_vm);
     }
-    catch(boost::program_options::error err) {
+    catch(boost::program_options::error &err) {
         throw runtime_error(string("error parsing command line: ") + err.what());
     }
 }
@@ -0,0 +1,358 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/compressedstream.h>
+#include <votca/tools/thread.h>
+#include <votca_config.h>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#ifdef HAVE_ZSTD
+#include <boost/iostreams/filter/zstd.hpp>
+#endif
+#include <boost/iostreams/copy.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+
+namespace votca { namespace tools {
+
+using namespace std;
+namespace io = boost::iostreams;
+
+namespace {
+
+// size of the blocks compressed in parallel
+const size_t GZIP_BLOCK_SIZE = 1 << 20;
+
+void push_compressor(io::filtering_ostream &out, Compression::Type type, int level)
+{
+    switch(type) {
+        case Compression::None:
+            break;
+        case Compression::Gzip:
+            out.push(io::gzip_compressor(io::gzip_params(level < 0 ? io::gzip::default_compression : level)));
+            break;
+        case Compression::Bzip2:
+            out.push(io::bzip2_compressor(io::bzip2_params(level < 0 ? io::bzip2::default_block_size : level)));
+            break;
+#ifdef HAVE_ZSTD
+        case Compression::Zstd:
+            out.push(io::zstd_compressor(io::zstd_params(level < 0 ? io::zstd::default_compression : level)));
+            break;
+#endif
+        default:
+            throw runtime_error(string("compression ") + Compression::Name(type) + " is not supported");
+    }
+}
+
+void push_decompressor(io::filtering_istream &in, Compression::Type type)
+{
+    switch(type) {
+        case Compression::None:
+            break;
+        case Compression::Gzip:
+            in.push(io::gzip_decompressor());
+            break;
+        case Compression::Bzip2:
+            in.push(io::bzip2_decompressor());
+            break;
+#ifdef HAVE_ZSTD
+        case Compression::Zstd:
+            in.push(io::zstd_decompressor());
+            break;
+#endif
+        default:
+            throw runtime_error(string("compression ") + Compression::Name(type) + " is not supported");
+    }
+}
+
+/**
+ * compresses one block into a gzip member
+ */
+class GzipWorker : public Thread
+{
+public:
+    GzipWorker(const string &in, string &out, int level)
+        : _in(in), _out(out), _level(level) {}
+
+    void Run() {
+        // exceptions must not leave the thread
+        try {
+            Compress();
+        } catch(std::exception &err) {
+            _error = err.what();
+        }
+    }
+
+    void Compress() {
+        _out = Compression::CompressBuffer(_in, Compression::Gzip, _level);
+    }
+
+    const string &getError() const { return _error; }
+
+private:
+    const string &_in;
+    string &_out;
+    int _level;
+    string _error;
+};
+
+/**
+ * sink which collects the data in blocks and compresses a batch of blocks
+ * with one thread per block
+ */
+class ParallelGzipSink
+{
+public:
+    typedef char char_type;
+    struct category : io::sink_tag, io::closable_tag {};
+
+    ParallelGzipSink(const string &filename, int threads, int level)
+        : _impl(new impl(filename, threads, level)) {}
+
+    std::streamsize write(const char *s, std::streamsize n) {
+        _impl->write(s, n);
+        return n;
+    }
+
+    void close() { _impl->close(); }
+
+private:
+    struct impl {
+        impl(const string &filename, int threads, int level)
+            : _threads(threads), _level(level)
+        {
+            _out.open(filename.c_str(), ios::binary);
+            if(!_out)
+                throw runtime_error("error, cannot open file " + filename);
+            _blocks.push_back(string());
+            _blocks.back().reserve(GZIP_BLOCK_SIZE);
+        }
+
+        void write(const char *s, std::streamsize n) {
+            while(n > 0) {
+                string &block = _blocks.back();
+                size_t chunk = min((size_t)n, GZIP_BLOCK_SIZE - block.size());
+                block.append(s, chunk);
+                s += chunk;
+                n -= chunk;
+                if(block.size() == GZIP_BLOCK_SIZE) {
+                    if(_blocks.size() == (size_t)_threads)
+                        flush();
+                    _blocks.push_back(string());
+                    _blocks.back().reserve(GZIP_BLOCK_SIZE);
+                }
+            }
+        }
+
+        void flush() {
+            vector<string> compressed(_blocks.size());
+            vector<GzipWorker *> workers;
+            for(size_t i=0; i<_blocks.size(); ++i)
+                workers.push_back(new GzipWorker(_blocks[i], compressed[i], _level));
+
+            // the last block is compressed by the calling thread
+            for(size_t i=0; i+1<workers.size(); ++i)
+                workers[i]->Start();
+            workers.back()->Run();
+            for(size_t i=0; i+1<workers.size(); ++i)
+                workers[i]->WaitDone();
+
+            string error;
+            for(size_t i=0; i<workers.size(); ++i) {
+                if(error.empty()) error = workers[i]->getError();
+                delete workers[i];
+            }
+            if(!error.empty())
+                throw runtime_error("error in gzip compression: " + error);
+
+            for(size_t i=0; i<compressed.size(); ++i)
+                _out.write(compressed[i].data(), compressed[i].size());
+            if(!_out)
+                throw runtime_error("error writing compressed file");
+            _blocks.clear();
+        }
+
+        void close() {
+            if(!_out.is_open()) return;
+            // full blocks are only flushed once _threads of them are
+            // queued, the last block is empty if the data ended on a
+            // block boundary
+            if(_blocks.back().empty())
+                _blocks.pop_back();
+            if(!_blocks.empty())
+                flush();
+            _out.close();
+        }
+
+        ofstream _out;
+        vector<string> _blocks;
+        int _threads;
+        int _level;
+    };
+
+    boost::shared_ptr<impl> _impl;
+};
+
+}
+
+Compression::Type Compression::FromFilename(const string &filename)
+{
+    if(boost::ends_with(filename, ".gz")) return Gzip;
+    if(boost::ends_with(filename, ".bz2")) return Bzip2;
+    if(boost::ends_with(filename, ".zst")) return Zstd;
+    return None;
+}
+
+Compression::Type Compression::Detect(const char *data, size_t size)
+{
+    const unsigned char *m = (const unsigned char *)data;
+    if(size >= 2 && m[0] == 0x1f && m[1] == 0x8b) return Gzip;
+    if(size >= 3 && m[0] == 'B' && m[1] == 'Z' && m[2] == 'h') return Bzip2;
+    if(size >= 4 && m[0] == 0x28 && m[1] == 0xb5 && m[2] == 0x2f && m[3] == 0xfd) return Zstd;
+    return None;
+}
+
+Compression::Type Compression::Detect(const string &filename)
+{
+    ifstream in(filename.c_str(), ios::binary);
+    char magic[4];
+    in.read(magic, 4);
+    return Detect(magic, in.gcount());
+}
+
+bool Compression::Available(Type type)
+{
+#ifndef HAVE_ZSTD
+    if(type == Zstd) return false;
+#endif
+    return type != Auto;
+}
+
+const char *Compression::Name(Type type)
+{
+    switch(type) {
+        case None: return "none";
+        case Gzip: return "gzip";
+        case Bzip2: return "bzip2";
+        case Zstd: return "zstd";
+        default: return "auto";
+    }
+}
+
+string Compression::CompressBuffer(const string &in, Type type, int level)
+{
+    string out;
+    io::filtering_ostream os;
+    push_compressor(os, type, level);
+    os.push(io::back_inserter(out));
+    os.write(in.data(), in.size());
+    os.reset();
+    return out;
+}
+
+string Compression::DecompressBuffer(const string &in, Type type)
+{
+    if(type == Auto)
+        type = Detect(in.data(), in.size());
+    string out;
+    io::filtering_istream is;
+    push_decompressor(is, type);
+    is.push(io::array_source(in.data(), in.size()));
+    io::copy(is, io::back_inserter(out));
+    return out;
+}
+
+CompressedIFStream::~CompressedIFStream()
+{
+    try {
+        reset();
+    } catch(...) {}
+}
+
+void CompressedIFStream::open(const string &filename)
+{
+    reset();
+    clear();
+    _type = Compression::None;
+
+    // check first, file_source does not report errors
+    ifstream test(filename.c_str(), ios::binary);
+    if(!test) {
+        setstate(ios::failbit);
+        return;
+    }
+    test.close();
+
+    _type = Compression::Detect(filename);
+    push_decompressor(*this, _type);
+    push(io::file_source(filename, ios::in | ios::binary));
+}
+
+void CompressedIFStream::close()
+{
+    reset();
+}
+
+CompressedOFStream::~CompressedOFStream()
+{
+    try {
+        reset();
+    } catch(...) {}
+}
+
+void CompressedOFStream::open(const string &filename, Compression::Type type, int threads, int level)
+{
+    reset();
+    clear();
+
+    if(type == Compression::Auto)
+        type = Compression::FromFilename(filename);
+    if(!Compression::Available(type))
+        throw runtime_error(string("compression ") + Compression::Name(type) + " is not supported");
+    _type = type;
+
+    ofstream test(filename.c_str(), ios::binary);
+    if(!test) {
+        setstate(ios::failbit);
+        return;
+    }
+    test.close();
+
+    if(type == Compression::Gzip) {
+        if(threads <= 0)
+            threads = max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+        push(ParallelGzipSink(filename, threads, level));
+        return;
+    }
+
+    push_compressor(*this, type, level);
+    push(io::file_sink(filename, ios::out | ios::binary));
+}
+
+void CompressedOFStream::close()
+{
+    reset();
+}
+
+}}
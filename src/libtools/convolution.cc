@@ -0,0 +1,276 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/convolution.h>
+#include <votca/tools/mutex.h>
+#include <boost/shared_ptr.hpp>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+// twiddle factors exp(-2 pi i j/n), j < n/2, interleaved (re, im)
+typedef boost::shared_ptr<const vector<double> > twiddles_t;
+
+// the twiddle factors are the plan of the FFT, they are kept for the
+// whole process (one per power of two), so repeated convolutions, e.g.
+// in the jobs of a batch run, do not compute them again
+static twiddles_t fft_twiddles(size_t n)
+{
+    static Mutex lock;
+    static map<size_t, twiddles_t> plans;
+    lock.Lock();
+    twiddles_t &plan = plans[n];
+    if(!plan) {
+        vector<double> *w = new vector<double>(n);
+        for(size_t j = 0; j < n / 2; ++j) {
+            (*w)[2 * j] = cos(2 * M_PI * j / n);
+            (*w)[2 * j + 1] = -sin(2 * M_PI * j / n);
+        }
+        plan.reset(w);
+    }
+    twiddles_t result = plan;
+    lock.Unlock();
+    return result;
+}
+
+// in place radix-2 FFT of interleaved complex data (re, im), n must be a
+// power of two, complex products are written out to avoid the checks of
+// std::complex
+static void fft(vector<double> &a, size_t n, const vector<double> &w, bool inverse)
+{
+    for(size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if(i < j) {
+            swap(a[2 * i], a[2 * j]);
+            swap(a[2 * i + 1], a[2 * j + 1]);
+        }
+    }
+    // w are the twiddle factors of the last stage, earlier stages use
+    // every k-th, the inverse uses their conjugates
+    double sign = inverse ? -1 : 1;
+    for(size_t len = 2; len <= n; len <<= 1) {
+        size_t half = len / 2, stride = n / len;
+        for(size_t i = 0; i < n; i += len)
+            for(size_t j = 0; j < half; ++j) {
+                const double *t = &w[2 * j * stride];
+                double tr = t[0], ti = sign * t[1];
+                double *u = &a[2 * (i + j)], *v = &a[2 * (i + j + half)];
+                double vr = v[0] * tr - v[1] * ti;
+                double vi = v[0] * ti + v[1] * tr;
+                v[0] = u[0] - vr;
+                v[1] = u[1] - vi;
+                u[0] += vr;
+                u[1] += vi;
+            }
+    }
+}
+
+// kernels longer than this are applied by FFT
+static const size_t DIRECT_KERNEL_LIMIT = 64;
+
+// value at index i of the data extended beyond its ends
+static double extended(const double *in, int n, int i, Convolution::Boundary boundary)
+{
+    if(i >= 0 && i < n) return in[i];
+    switch(boundary) {
+        case Convolution::Zero:
+            return 0;
+        case Convolution::Nearest:
+            return i < 0 ? in[0] : in[n - 1];
+        case Convolution::Mirror:
+        default:
+            if(n == 1) return in[0];
+            // reflection is periodic with 2(n-1)
+            int period = 2 * (n - 1);
+            i %= period;
+            if(i < 0) i += period;
+            return i < n ? in[i] : in[period - i];
+    }
+}
+
+void Convolution::Binomial(int passes, vector<double> &kernel)
+{
+    if(passes < 0)
+        throw invalid_argument("Convolution::Binomial: negative number of passes");
+    int n = 2 * passes;
+    vector<double> c(n + 1);
+    // in log space, 4^n overflows for several hundred passes
+    for(int k = 0; k <= n; ++k)
+        c[k] = exp(lgamma(n + 1.) - lgamma(k + 1.) - lgamma(n - k + 1.) - n * log(2.));
+
+    // cut symmetric tails below double precision
+    int cut = 0;
+    while(cut < passes && c[cut] < 1e-18 * c[passes])
+        ++cut;
+    kernel.assign(c.begin() + cut, c.end() - cut);
+    double sum = 0;
+    for(size_t k = 0; k < kernel.size(); ++k) sum += kernel[k];
+    for(size_t k = 0; k < kernel.size(); ++k) kernel[k] /= sum;
+}
+
+void Convolution::Gaussian(double sigma, vector<double> &kernel)
+{
+    if(sigma < 0)
+        throw invalid_argument("Convolution::Gaussian: negative sigma");
+    // exp(-x^2/2) < 1e-18 beyond 9.1 sigma
+    int m = (int)ceil(9.1 * sigma);
+    kernel.resize(2 * m + 1);
+    double sum = 0;
+    for(int k = -m; k <= m; ++k) {
+        kernel[k + m] = sigma > 0 ? exp(-0.5 * k * k / (sigma * sigma)) : 1;
+        sum += kernel[k + m];
+    }
+    for(size_t k = 0; k < kernel.size(); ++k) kernel[k] /= sum;
+}
+
+void Convolution::SavitzkyGolay(int m, int order, int pos, vector<double> &coeff)
+{
+    if(m < 0 || order < 0 || order > 2 * m)
+        throw invalid_argument("Convolution::SavitzkyGolay: order must be less than the window size");
+    if(pos < -m || pos > m)
+        throw invalid_argument("Convolution::SavitzkyGolay: position outside of the window");
+
+    // normal equations of the least squares fit, G a = A^T y with A_jk = x_j^k,
+    // x_j = j/m keeps G well conditioned for wide windows
+    int p = order + 1;
+    double scale = m > 0 ? 1. / m : 1.;
+    vector<double> g(p * p, 0.), powers(p);
+    for(int j = -m; j <= m; ++j) {
+        double t = 1;
+        for(int k = 0; k < p; ++k, t *= j * scale) powers[k] = t;
+        for(int r = 0; r < p; ++r)
+            for(int c = 0; c < p; ++c)
+                g[r * p + c] += powers[r] * powers[c];
+    }
+
+    // the value at pos is b^T a with b_k = pos^k, solve G z = b
+    vector<double> z(p);
+    double t = 1;
+    for(int k = 0; k < p; ++k, t *= pos * scale) z[k] = t;
+    // gaussian elimination with partial pivoting
+    for(int col = 0; col < p; ++col) {
+        int pivot = col;
+        for(int r = col + 1; r < p; ++r)
+            if(fabs(g[r * p + col]) > fabs(g[pivot * p + col])) pivot = r;
+        for(int c = 0; c < p; ++c) swap(g[col * p + c], g[pivot * p + c]);
+        swap(z[col], z[pivot]);
+        for(int r = col + 1; r < p; ++r) {
+            double f = g[r * p + col] / g[col * p + col];
+            for(int c = col; c < p; ++c) g[r * p + c] -= f * g[col * p + c];
+            z[r] -= f * z[col];
+        }
+    }
+    for(int r = p - 1; r >= 0; --r) {
+        for(int c = r + 1; c < p; ++c) z[r] -= g[r * p + c] * z[c];
+        z[r] /= g[r * p + r];
+    }
+
+    // coefficient of window point j is sum_k z_k x_j^k
+    coeff.resize(2 * m + 1);
+    for(int j = -m; j <= m; ++j) {
+        double c = 0, t = 1;
+        for(int k = 0; k < p; ++k, t *= j * scale) c += z[k] * t;
+        coeff[j + m] = c;
+    }
+}
+
+void Convolution::Apply(const double *in, double *out, int n,
+        const vector<double> &kernel, Boundary boundary)
+{
+    if(kernel.size() % 2 != 1)
+        throw invalid_argument("Convolution::Apply: kernel must have odd length");
+    if(n <= 0) return;
+    int m = kernel.size() / 2;
+
+    // data with m extended points on both sides
+    vector<double> ext(n + 2 * m);
+    for(int i = -m; i < n + m; ++i)
+        ext[i + m] = extended(in, n, i, boundary);
+
+    size_t K = kernel.size();
+    if(K <= DIRECT_KERNEL_LIMIT) {
+        for(int i = 0; i < n; ++i) {
+            double s = 0;
+            for(int k = 0; k <= 2 * m; ++k)
+                s += kernel[k] * ext[i + 2 * m - k];
+            out[i] = s;
+        }
+        return;
+    }
+
+    // overlap-save: blocks of P points give P-K+1 results each, so the
+    // cost is O(N log K)
+    size_t P = 1;
+    while(P < 4 * K) P <<= 1;
+    size_t L = P - K + 1;
+    twiddles_t w = fft_twiddles(P);
+    vector<double> h(2 * P, 0.), a(2 * P);
+    for(size_t k = 0; k < K; ++k) h[2 * k] = kernel[k];
+    fft(h, P, *w, false);
+
+    for(size_t start = 0; start < (size_t)n; start += L) {
+        for(size_t j = 0; j < P; ++j) {
+            a[2 * j] = start + j < ext.size() ? ext[start + j] : 0;
+            a[2 * j + 1] = 0;
+        }
+        fft(a, P, *w, false);
+        for(size_t j = 0; j < P; ++j) {
+            double re = a[2 * j] * h[2 * j] - a[2 * j + 1] * h[2 * j + 1];
+            double im = a[2 * j] * h[2 * j + 1] + a[2 * j + 1] * h[2 * j];
+            a[2 * j] = re;
+            a[2 * j + 1] = im;
+        }
+        fft(a, P, *w, true);
+        // circular wrap-around only spoils the first K-1 points of a block
+        for(size_t j = K - 1; j < P && start + j - (K - 1) < (size_t)n; ++j)
+            out[start + j - (K - 1)] = a[2 * j] / P;
+    }
+}
+
+void Convolution::ApplySavitzkyGolay(const double *in, double *out, int n, int m, int order)
+{
+    if(n < 2 * m + 1)
+        throw invalid_argument("Convolution::ApplySavitzkyGolay: less points than the window size");
+
+    // ends from the fit to the first and last window, before out is overwritten
+    vector<double> head(m), tail(m), coeff;
+    for(int i = 0; i < m; ++i) {
+        SavitzkyGolay(m, order, i - m, coeff);
+        head[i] = tail[m - 1 - i] = 0;
+        for(int j = 0; j <= 2 * m; ++j) {
+            head[i] += coeff[j] * in[j];
+            // fit at position m - i of the last window, by symmetry reversed coefficients
+            tail[m - 1 - i] += coeff[j] * in[n - 1 - j];
+        }
+    }
+
+    SavitzkyGolay(m, order, 0, coeff);
+    Apply(in, out, n, coeff, Mirror);
+    for(int i = 0; i < m; ++i) {
+        out[i] = head[i];
+        out[n - m + i] = tail[i];
+    }
+}
+
+}}
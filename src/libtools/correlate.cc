@@ -15,7 +15,9 @@
  */
 
 #include <votca/tools/correlate.h>
+#include <votca/tools/datachunksource.h>
 #include <math.h>
+#include <stdexcept>
 
 namespace votca { namespace tools {
 
@@ -50,4 +52,53 @@ void Correlate::CalcCorrelations(DataCollection<double>::selection *data)
     }
 }
 
+void Correlate::CalcCorrelations(DataChunkSource &source)
+{
+    vector< vector<double> > chunk;
+    // sums of the values shifted by the first value of each array, the
+    // correlation does not depend on the shift but cancellation is reduced
+    vector<double> shift, sum, sumsq, sumxy;
+    double N = 0;
+
+    while(source.Next(chunk)) {
+        if(chunk.empty() || chunk[0].empty()) continue;
+        if(shift.empty()) {
+            for(size_t v=0; v<chunk.size(); ++v)
+                shift.push_back(chunk[v][0]);
+            sum.assign(shift.size(), 0);
+            sumsq.assign(shift.size(), 0);
+            sumxy.assign(shift.size(), 0);
+        }
+        if(chunk.size() != shift.size())
+            throw runtime_error("number of arrays changed in data source");
+
+        const vector<double> &x = chunk[0];
+        for(size_t v=0; v<chunk.size(); ++v) {
+            const vector<double> &y = chunk[v];
+            if(y.size() != x.size())
+                throw runtime_error("arrays in chunk have different length");
+            double s = 0, sq = 0, xy = 0;
+            for(size_t i=0; i<y.size(); ++i) {
+                double dy = y[i] - shift[v];
+                s += dy;
+                sq += dy*dy;
+                xy += dy*(x[i] - shift[0]);
+            }
+            sum[v] += s;
+            sumsq[v] += sq;
+            sumxy[v] += xy;
+        }
+        N += x.size();
+    }
+
+    for(size_t v=1; v<shift.size(); v++) {
+        pair<string, double> p("do_names", 0);
+        double xm = sum[0]/N;
+        double ym = sum[v]/N;
+        double norm = (sumsq[0] - N*xm*xm)*(sumsq[v] - N*ym*ym);
+        p.second = (sumxy[v] - N*xm*ym) / sqrt(norm);
+        _corr.push_back(p);
+    }
+}
+
 }}
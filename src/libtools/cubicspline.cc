@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/cubicspline.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
@@ -29,6 +30,8 @@ using namespace std;
 
 void CubicSpline::Interpolate(ub::vector<double> &x, ub::vector<double> &y)
 {    
+    ScopedTimer timer("CubicSpline::Interpolate");
+
     if(x.size() != y.size())
         throw std::invalid_argument("error in CubicSpline::Interpolate : sizes of vectors x and y do not match");
     
@@ -82,6 +85,8 @@ void CubicSpline::Interpolate(ub::vector<double> &x, ub::vector<double> &y)
 
 void CubicSpline::Fit(ub::vector<double> &x, ub::vector<double> &y)
 {
+    ScopedTimer timer("CubicSpline::Fit");
+
     if(x.size() != y.size())
         throw std::invalid_argument("error in CubicSpline::Fit : sizes of vectors x and y do not match");
     
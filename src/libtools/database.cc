@@ -31,14 +31,18 @@ Database::~Database()
 void Database::Open(string file, int flags)
 {
     int ret = sqlite3_open_v2(file.c_str(),&_db,flags,NULL);
-    if(ret != SQLITE_OK)
+    if(ret != SQLITE_OK) {
+        // sqlite allocates a handle even if opening fails
+        Close();
         throw std::runtime_error("cannot open database " + file);
+    }
 }
 
 void Database::OpenHelper(string file)
 {
     int ret = sqlite3_open_v2(file.c_str(),&_db,SQLITE_OPEN_READWRITE,NULL);
     if(ret != SQLITE_OK) {
+        Close();
         Open(file, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
         onCreate();
     }
@@ -59,6 +63,7 @@ void Database::Close()
 {
     if(_db)
         sqlite3_close(_db);
+    _db = NULL;
 }
 
 void Database::Exec(string sql)
@@ -85,5 +90,89 @@ int Database::LastInsertRowId()
     return sqlite3_last_insert_rowid(_db);
 }
 
+DatabasePool::DatabasePool(const string &file, int max_connections, bool shared_cache)
+    : _file(file), _max_connections(max_connections)
+{
+    if(!sqlite3_threadsafe())
+        throw std::runtime_error("DatabasePool: sqlite3 library was compiled without thread support");
+    // every connection is only used by one thread, so no sqlite mutexes needed
+    _flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+    if(shared_cache)
+        _flags |= SQLITE_OPEN_SHAREDCACHE;
+    if(pthread_key_create(&_key, &DatabasePool::ThreadExit) != 0)
+        throw std::runtime_error("DatabasePool: cannot create thread key");
+}
+
+DatabasePool::~DatabasePool()
+{
+    // no thread exit handlers from here on
+    pthread_key_delete(_key);
+    std::map<pthread_t, Database *>::iterator iter;
+    for(iter = _connections.begin(); iter != _connections.end(); ++iter)
+        delete iter->second;
+}
+
+Database &DatabasePool::Connection()
+{
+    pthread_t self = pthread_self();
+
+    _lock.Lock();
+    std::map<pthread_t, Database *>::iterator iter = _connections.find(self);
+    if(iter != _connections.end()) {
+        Database *db = iter->second;
+        _lock.Unlock();
+        return *db;
+    }
+    if(_max_connections > 0 && (int)_connections.size() >= _max_connections) {
+        _lock.Unlock();
+        throw std::runtime_error("DatabasePool: maximum number of connections to " + _file + " reached");
+    }
+    // reserve the slot, opening is done outside of the lock
+    Database *db = new Database();
+    _connections[self] = db;
+    _lock.Unlock();
+
+    try {
+        db->Open(_file, _flags);
+    }
+    catch(std::exception &err) {
+        _lock.Lock();
+        _connections.erase(self);
+        _lock.Unlock();
+        delete db;
+        throw;
+    }
+    pthread_setspecific(_key, this);
+    return *db;
+}
+
+void DatabasePool::ThreadExit(void *pool)
+{
+    // runs in the exiting thread, so Release finds its connection
+    static_cast<DatabasePool *>(pool)->Release();
+}
+
+void DatabasePool::Release()
+{
+    Database *db = NULL;
+    _lock.Lock();
+    std::map<pthread_t, Database *>::iterator iter = _connections.find(pthread_self());
+    if(iter != _connections.end()) {
+        db = iter->second;
+        _connections.erase(iter);
+    }
+    _lock.Unlock();
+    pthread_setspecific(_key, NULL);
+    delete db;
+}
+
+int DatabasePool::size()
+{
+    _lock.Lock();
+    int n = _connections.size();
+    _lock.Unlock();
+    return n;
+}
+
 }}
 
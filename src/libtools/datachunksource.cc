@@ -0,0 +1,113 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/datachunksource.h>
+#include <boost/lexical_cast.hpp>
+#include <stdexcept>
+#include <stdlib.h>
+
+namespace votca { namespace tools {
+
+void DataChunkSource::Rewind()
+{
+    throw runtime_error("data source cannot be rewound");
+}
+
+DataStoreChunkSource::DataStoreChunkSource(const DataStoreReader &reader, const string &pattern,
+    size_t chunk_size)
+    : _reader(reader), _chunk_size(chunk_size), _pos(0)
+{
+    _arrays = reader.Select(pattern);
+}
+
+bool DataStoreChunkSource::Next(vector< vector<double> > &data)
+{
+    if(_pos >= _reader.Frames() || _arrays.empty()) return false;
+    size_t n = min(_chunk_size, _reader.Frames() - _pos);
+    data.resize(_arrays.size());
+    for(size_t i=0; i<_arrays.size(); ++i) {
+        data[i].resize(n);
+        _reader.Read(_arrays[i], _pos, n, &data[i][0]);
+    }
+    _pos += n;
+    return true;
+}
+
+vector<string> DataStoreChunkSource::getNames() const
+{
+    vector<string> names;
+    for(size_t i=0; i<_arrays.size(); ++i)
+        names.push_back(_reader.Arrays()[_arrays[i]]);
+    return names;
+}
+
+TextChunkSource::TextChunkSource(const string &filename, size_t chunk_size)
+    : _filename(filename), _chunk_size(chunk_size), _columns(0), _line(0)
+{
+    Rewind();
+}
+
+void TextChunkSource::Rewind()
+{
+    _in.open(_filename);
+    if(!_in)
+        throw runtime_error("error, cannot open file " + _filename);
+    _line = 0;
+}
+
+bool TextChunkSource::Next(vector< vector<double> > &data)
+{
+    string line;
+    vector<double> values;
+    for(size_t i=0; i<data.size(); ++i)
+        data[i].clear();
+
+    size_t n = 0;
+    while(n < _chunk_size && getline(_in, line)) {
+        ++_line;
+        // remove comments and xmgrace stuff, as Table does
+        line = line.substr(0, line.find_first_of("#@"));
+
+        // strtod instead of Tokenizer + lexical_cast, this is the hot loop
+        values.clear();
+        const char *p = line.c_str();
+        while(true) {
+            while(*p == ' ' || *p == '\t' || *p == '\r') ++p;
+            if(*p == 0) break;
+            char *end;
+            values.push_back(strtod(p, &end));
+            if(end == p || (*end != 0 && *end != ' ' && *end != '\t' && *end != '\r'))
+                throw runtime_error(_filename + ", line " + boost::lexical_cast<string>(_line)
+                    + ": cannot convert to double");
+            p = end;
+        }
+        if(values.empty()) continue;
+
+        if(_columns == 0)
+            _columns = values.size();
+        if(values.size() != _columns)
+            throw runtime_error(_filename + ", line " + boost::lexical_cast<string>(_line)
+                + ": wrong number of columns");
+        data.resize(_columns);
+        for(size_t i=0; i<_columns; ++i)
+            data[i].push_back(values[i]);
+        ++n;
+    }
+    return n > 0;
+}
+
+}}
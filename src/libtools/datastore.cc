@@ -0,0 +1,435 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/datastore.h>
+#include <votca/tools/tokenizer.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace votca { namespace tools {
+
+/*
+ * file layout (native byte order, all sections aligned to 8 bytes)
+ *
+ *   header   "VOTCADS" 0, uint32 version, uint32 byte order mark
+ *   chunks   raw or compressed doubles
+ *   index    uint64 #arrays, uint64 #frames
+ *            per array: uint64 name length, name, uint64 #chunks,
+ *                       DataStoreChunk entries
+ *   trailer  uint64 offset of index, "VDSINDEX"
+ */
+
+namespace {
+
+const char DS_MAGIC[8] = { 'V', 'O', 'T', 'C', 'A', 'D', 'S', 0 };
+const char DS_INDEX_MAGIC[8] = { 'V', 'D', 'S', 'I', 'N', 'D', 'E', 'X' };
+const unsigned int DS_VERSION = 1;
+const unsigned int DS_BOM = 0x01020304;
+const size_t DS_HEADER_SIZE = 16;
+const size_t DS_TRAILER_SIZE = 16;
+
+template<typename T>
+void put(string &buf, const T &value)
+{
+    buf.append((const char *)&value, sizeof(T));
+}
+
+template<typename T>
+T get(const char *&p, const char *end)
+{
+    if(p + sizeof(T) > end)
+        throw runtime_error("data store index is truncated");
+    T value;
+    memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+}
+
+DataStoreWriter::DataStoreWriter()
+    : _buffered(0), _frames(0), _pos(0), _chunk_frames(4096), _compression(Compression::None)
+{}
+
+DataStoreWriter::~DataStoreWriter()
+{
+    try {
+        Close();
+    } catch(...) {}
+}
+
+void DataStoreWriter::Open(const string &filename, const vector<string> &arrays, bool append)
+{
+    Close();
+    if(!Compression::Available(_compression))
+        throw runtime_error(string("compression ") + Compression::Name(_compression) + " is not supported");
+
+    _filename = filename;
+    _names = arrays;
+    _chunks.clear();
+    _chunks.resize(_names.size());
+    _buffer.clear();
+    _buffer.resize(_names.size());
+    _buffered = 0;
+    _frames = 0;
+
+    struct stat st;
+    if(append && stat(filename.c_str(), &st) == 0) {
+        DataStoreReader in(filename);
+        if(in.Arrays() != _names)
+            throw runtime_error("cannot append to " + filename + ", arrays do not match");
+        for(size_t i=0; i<_names.size(); ++i)
+            _chunks[i] = in.Chunks(i);
+        _frames = in.Frames();
+        // new chunks overwrite the old index
+        _out.open(filename.c_str(), ios::in | ios::out | ios::binary);
+        if(!_out)
+            throw runtime_error("error, cannot open file " + filename);
+        _out.seekg(-(streamoff)DS_TRAILER_SIZE, ios::end);
+        _out.read((char *)&_pos, sizeof(_pos));
+        _out.seekp(_pos);
+        return;
+    }
+
+    _out.open(filename.c_str(), ios::out | ios::trunc | ios::binary);
+    if(!_out)
+        throw runtime_error("error, cannot open file " + filename);
+    string header(DS_MAGIC, 8);
+    put(header, DS_VERSION);
+    put(header, DS_BOM);
+    _out.write(header.data(), header.size());
+    _pos = header.size();
+}
+
+void DataStoreWriter::Open(const string &filename, DataCollection<double> &data, bool append)
+{
+    vector<string> names;
+    for(DataCollection<double>::iterator iter = data.begin(); iter != data.end(); ++iter)
+        names.push_back((*iter)->getName());
+    Open(filename, names, append);
+}
+
+void DataStoreWriter::AppendFrame(const double *values)
+{
+    if(!_out.is_open())
+        throw runtime_error("data store is not open");
+    for(size_t i=0; i<_names.size(); ++i)
+        _buffer[i].push_back(values[i]);
+    if(++_buffered >= _chunk_frames)
+        Flush();
+}
+
+void DataStoreWriter::AppendFrame(const vector<double> &values)
+{
+    if(values.size() != _names.size())
+        throw runtime_error("data store frame has the wrong number of values");
+    AppendFrame(&values[0]);
+}
+
+void DataStoreWriter::Append(DataCollection<double> &data)
+{
+    vector<DataCollection<double>::array *> arrays;
+    for(size_t i=0; i<_names.size(); ++i) {
+        DataCollection<double>::array *a = data.ArrayByName(_names[i]);
+        if(!a)
+            throw runtime_error("data store array " + _names[i] + " not found in collection");
+        if(!arrays.empty() && a->size() != arrays.front()->size())
+            throw runtime_error("arrays in collection have different length");
+        arrays.push_back(a);
+    }
+    if(arrays.empty()) return;
+
+    vector<double> frame(arrays.size());
+    for(size_t f=0; f<arrays.front()->size(); ++f) {
+        for(size_t i=0; i<arrays.size(); ++i)
+            frame[i] = (*arrays[i])[f];
+        AppendFrame(&frame[0]);
+    }
+}
+
+void DataStoreWriter::Flush()
+{
+    if(_buffered == 0) return;
+
+    for(size_t i=0; i<_names.size(); ++i) {
+        string data((const char *)&_buffer[i][0], _buffered*sizeof(double));
+        if(_compression != Compression::None)
+            data = Compression::CompressBuffer(data, _compression);
+
+        DataStoreChunk chunk;
+        chunk._offset = _pos;
+        chunk._size = data.size();
+        chunk._first = _frames;
+        chunk._frames = _buffered;
+        chunk._compression = _compression;
+        _chunks[i].push_back(chunk);
+
+        // keep chunks aligned for direct access from the mapping
+        data.resize((data.size() + 7) & ~(size_t)7, 0);
+        _out.write(data.data(), data.size());
+        _pos += data.size();
+        _buffer[i].clear();
+    }
+    if(!_out)
+        throw runtime_error("error writing data store " + _filename);
+    _frames += _buffered;
+    _buffered = 0;
+}
+
+void DataStoreWriter::WriteIndex()
+{
+    string index;
+    put(index, (unsigned long long)_names.size());
+    put(index, (unsigned long long)_frames);
+    for(size_t i=0; i<_names.size(); ++i) {
+        put(index, (unsigned long long)_names[i].size());
+        index.append(_names[i]);
+        put(index, (unsigned long long)_chunks[i].size());
+        for(size_t c=0; c<_chunks[i].size(); ++c) {
+            const DataStoreChunk &chunk = _chunks[i][c];
+            put(index, chunk._offset);
+            put(index, chunk._size);
+            put(index, chunk._first);
+            put(index, chunk._frames);
+            put(index, chunk._compression);
+        }
+    }
+    index.resize((index.size() + 7) & ~(size_t)7, 0);
+    put(index, _pos);
+    index.append(DS_INDEX_MAGIC, 8);
+    _out.write(index.data(), index.size());
+    _pos += index.size();
+}
+
+void DataStoreWriter::Close()
+{
+    if(!_out.is_open()) return;
+    Flush();
+    WriteIndex();
+    _out.close();
+    if(!_out)
+        throw runtime_error("error writing data store " + _filename);
+    // an appended store might be shorter than the old one
+    if(truncate(_filename.c_str(), _pos) != 0)
+        throw runtime_error("error truncating data store " + _filename);
+}
+
+DataStoreReader::DataStoreReader()
+    : _map(NULL), _map_size(0), _frames(0)
+{}
+
+DataStoreReader::DataStoreReader(const string &filename)
+    : _map(NULL), _map_size(0), _frames(0)
+{
+    Open(filename);
+}
+
+DataStoreReader::~DataStoreReader()
+{
+    Close();
+}
+
+void DataStoreReader::Open(const string &filename)
+{
+    Close();
+    _filename = filename;
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw runtime_error("error, cannot open file " + filename);
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)(DS_HEADER_SIZE + DS_TRAILER_SIZE)) {
+        ::close(fd);
+        throw runtime_error(filename + " is not a data store");
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED)
+        throw runtime_error("error, cannot map file " + filename);
+    _map = (const char *)map;
+    _map_size = st.st_size;
+
+    try {
+        ReadIndex();
+    } catch(...) {
+        Close();
+        throw;
+    }
+}
+
+void DataStoreReader::ReadIndex()
+{
+    const char *end = _map + _map_size;
+    const char *p = _map;
+    if(memcmp(p, DS_MAGIC, 8) != 0)
+        throw runtime_error(_filename + " is not a data store");
+    p += 8;
+    if(get<unsigned int>(p, end) != DS_VERSION)
+        throw runtime_error(_filename + " has an unsupported data store version");
+    if(get<unsigned int>(p, end) != DS_BOM)
+        throw runtime_error(_filename + " was written with a different byte order");
+
+    p = end - DS_TRAILER_SIZE;
+    unsigned long long index = get<unsigned long long>(p, end);
+    if(memcmp(p, DS_INDEX_MAGIC, 8) != 0 || index > _map_size - DS_TRAILER_SIZE)
+        throw runtime_error(_filename + " has no index, the writer was not closed");
+
+    // nothing read from the index is trusted: counts are bounded by the
+    // bytes left, chunks have to lie before the index and cover the frames
+    // of their array without gaps, so Read never leaves the mapping
+    p = _map + index;
+    end = _map + _map_size - DS_TRAILER_SIZE;
+    unsigned long long narrays = get<unsigned long long>(p, end);
+    _frames = get<unsigned long long>(p, end);
+    // name length and number of chunks per array
+    if(narrays > (unsigned long long)(end - p) / 16)
+        throw runtime_error("data store index is corrupt");
+    _names.resize(narrays);
+    _chunks.resize(narrays);
+    for(size_t i=0; i<narrays; ++i) {
+        unsigned long long len = get<unsigned long long>(p, end);
+        if(len > (unsigned long long)(end - p))
+            throw runtime_error("data store index is truncated");
+        _names[i].assign(p, len);
+        p += len;
+        unsigned long long nchunks = get<unsigned long long>(p, end);
+        // offset, size, first frame, frames and compression per chunk
+        if(nchunks > (unsigned long long)(end - p) / 32)
+            throw runtime_error("data store index is corrupt");
+        _chunks[i].resize(nchunks);
+        unsigned long long frames = 0;
+        for(size_t c=0; c<nchunks; ++c) {
+            DataStoreChunk &chunk = _chunks[i][c];
+            chunk._offset = get<unsigned long long>(p, end);
+            chunk._size = get<unsigned long long>(p, end);
+            chunk._first = get<unsigned long long>(p, end);
+            chunk._frames = get<unsigned int>(p, end);
+            chunk._compression = get<unsigned int>(p, end);
+            if(chunk._offset < DS_HEADER_SIZE || chunk._offset > index
+                    || chunk._size > index - chunk._offset
+                    || chunk._first != frames || chunk._frames == 0
+                    || chunk._compression >= Compression::Auto
+                    || (chunk._compression == Compression::None
+                        && chunk._size != chunk._frames*sizeof(double)))
+                throw runtime_error("data store index is corrupt");
+            frames += chunk._frames;
+        }
+        if(frames != _frames)
+            throw runtime_error("data store index is corrupt");
+    }
+}
+
+void DataStoreReader::Close()
+{
+    if(_map)
+        munmap((void *)_map, _map_size);
+    _map = NULL;
+    _map_size = 0;
+    _names.clear();
+    _chunks.clear();
+    _frames = 0;
+}
+
+int DataStoreReader::ArrayIndex(const string &name) const
+{
+    for(size_t i=0; i<_names.size(); ++i)
+        if(_names[i] == name) return i;
+    return -1;
+}
+
+vector<int> DataStoreReader::Select(const string &pattern) const
+{
+    vector<int> selected;
+    WildcardMatcher matcher(pattern);
+    for(size_t i=0; i<_names.size(); ++i)
+        if(matcher.Match(_names[i]))
+            selected.push_back(i);
+    return selected;
+}
+
+void DataStoreReader::Read(int array, size_t first, size_t n, double *out) const
+{
+    if(array < 0 || array >= (int)_names.size())
+        throw runtime_error("data store array index out of range");
+    if(first + n > _frames)
+        throw runtime_error("data store frame range out of range");
+    if(n == 0) return;
+
+    const vector<DataStoreChunk> &chunks = _chunks[array];
+    // find the first chunk by bisection
+    size_t lo = 0, hi = chunks.size();
+    while(hi - lo > 1) {
+        size_t mid = (lo + hi)/2;
+        if(chunks[mid]._first <= first) lo = mid;
+        else hi = mid;
+    }
+
+    size_t end = first + n;
+    for(size_t c=lo; c<chunks.size() && first < end; ++c) {
+        const DataStoreChunk &chunk = chunks[c];
+        size_t from = first - chunk._first;
+        size_t count = min((size_t)(chunk._first + chunk._frames), end) - first;
+        const char *data = _map + chunk._offset;
+
+        if(chunk._compression == Compression::None) {
+            memcpy(out, data + from*sizeof(double), count*sizeof(double));
+        } else {
+            string raw = Compression::DecompressBuffer(string(data, chunk._size),
+                (Compression::Type)chunk._compression);
+            if(raw.size() != chunk._frames*sizeof(double))
+                throw runtime_error("data store chunk is corrupt");
+            memcpy(out, raw.data() + from*sizeof(double), count*sizeof(double));
+        }
+        out += count;
+        first += count;
+    }
+}
+
+void DataStoreReader::Read(int array, vector<double> &out) const
+{
+    out.resize(_frames);
+    if(_frames)
+        Read(array, 0, _frames, &out[0]);
+}
+
+DataCollection<double>::selection *DataStoreReader::Load(DataCollection<double> &data,
+    const string &pattern, size_t first, size_t n) const
+{
+    if(first > _frames)
+        throw runtime_error("data store frame range out of range");
+    if(n == 0)
+        n = _frames - first;
+
+    DataCollection<double>::selection *sel = new DataCollection<double>::selection;
+    vector<int> selected = Select(pattern);
+    for(size_t i=0; i<selected.size(); ++i) {
+        DataCollection<double>::array *a = data.ArrayByName(_names[selected[i]]);
+        if(!a)
+            a = data.CreateArray(_names[selected[i]]);
+        a->resize(n);
+        if(n)
+            Read(selected[i], first, n, &(*a)[0]);
+        sel->push_back(a);
+    }
+    return sel;
+}
+
+}}
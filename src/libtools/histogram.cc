@@ -18,7 +18,10 @@
 #include <limits>
 #include <math.h>
 #include <numeric>
+#include <stdexcept>
 #include <votca/tools/histogram.h>
+#include <votca/tools/profiler.h>
+#include <votca/tools/datachunksource.h>
 
 namespace votca { namespace tools {
 
@@ -37,9 +40,9 @@ Histogram::~Histogram()
 
 void Histogram::ProcessData(DataCollection<double>::selection *data)
 {
+    ScopedTimer timer("Histogram::ProcessData");
     DataCollection<double>::selection::iterator array;
     DataCollection<double>::array::iterator iter;
-    int ii;
     int ndata = 0;
     
     _pdf.assign(_options._n, 0);
@@ -70,21 +73,77 @@ void Histogram::ProcessData(DataCollection<double>::selection *data)
     
     _interval = (_max - _min)/(double)(_options._n-1);
 
-    double v = 1.;
     for(array = data->begin(); array!=data->end(); ++array) {
-        for(iter=(*array)->begin(); iter!=(*array)->end(); ++iter) {
-            ii = (int)( (*iter - _min) / _interval + 0.5); // the interval should be centered around the sampling point              
-            if(ii< 0 || ii >= _options._n) {
-                if(_options._periodic) {
-                    while(ii<0) ii+=_options._n;
-                    ii = ii % _options._n;
+        if(!(*array)->empty())
+            Bin(&(**array)[0], (*array)->size());
+    }
+
+    Finish();
+}
+
+void Histogram::ProcessStream(DataChunkSource &source)
+{
+    ScopedTimer timer("Histogram::ProcessStream");
+    vector< vector<double> > chunk;
+
+    // the range pass consumes the source, fail before reading anything
+    if((_options._auto_interval || _options._extend_interval) && !source.CanRewind())
+        throw runtime_error("Histogram::ProcessStream: automatic or extended interval needs a source which can be rewound");
+
+    _pdf.assign(_options._n, 0);
+
+    if(_options._auto_interval) {
+        _min = numeric_limits<double>::max();
+        _max = numeric_limits<double>::min();
+        _options._extend_interval = true;
+    }
+    else {
+        _min = _options._min;
+        _max = _options._max;
+    }
+
+    // first pass for the range
+    if(_options._extend_interval) {
+        while(source.Next(chunk)) {
+            for(size_t i=0; i<chunk.size(); ++i)
+                for(size_t j=0; j<chunk[i].size(); ++j) {
+                    _min = min(chunk[i][j], _min);
+                    _max = max(chunk[i][j], _max);
                 }
-                else { continue; } //cout << "[histogram.cc]: out of bounds" << endl; continue;}
+        }
+        source.Rewind();
+    }
+
+    _interval = (_max - _min)/(double)(_options._n-1);
+
+    while(source.Next(chunk)) {
+        for(size_t i=0; i<chunk.size(); ++i)
+            if(!chunk[i].empty())
+                Bin(&chunk[i][0], chunk[i].size());
+    }
+
+    Finish();
+}
+
+void Histogram::Bin(const double *values, size_t n)
+{
+    int ii;
+    double v = 1.;
+    for(size_t i=0; i<n; ++i) {
+        ii = (int)( (values[i] - _min) / _interval + 0.5); // the interval should be centered around the sampling point
+        if(ii< 0 || ii >= _options._n) {
+            if(_options._periodic) {
+                while(ii<0) ii+=_options._n;
+                ii = ii % _options._n;
             }
-            _pdf[ii]+= v;
+            else { continue; } //cout << "[histogram.cc]: out of bounds" << endl; continue;}
         }
-    }        
-    
+        _pdf[ii]+= v;
+    }
+}
+
+void Histogram::Finish()
+{
     //cout << _pdf.size() << " " << _options._periodic << endl;
     if(_options._scale == "bond") {
         for(size_t i=0; i<_pdf.size(); ++i) {
@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include <gsl/gsl_linalg.h>
@@ -27,6 +28,7 @@ namespace votca { namespace tools {
 using namespace std;
 
 void linalg_cholesky_decompose( ub::matrix<double> &A){
+    ScopedTimer timer("linalg_cholesky_decompose");
         // Cholesky decomposition using GSL
         const size_t N = A.size1();
         
@@ -37,6 +39,7 @@ void linalg_cholesky_decompose( ub::matrix<double> &A){
 }
 
 void linalg_cholesky_solve(ub::vector<double> &x, ub::matrix<double> &A, ub::vector<double> &b){
+    ScopedTimer timer("linalg_cholesky_solve");
     /* calling program should catch the error error code GSL_EDOM
      * thrown by gsl_linalg_cholesky_decomp and take
      * necessary steps
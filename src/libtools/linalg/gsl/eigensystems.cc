@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <math.h>       /* sqrt */
@@ -36,6 +37,7 @@ using namespace std;
 */
 bool linalg_eigenvalues_symmetric( ub::symmetric_matrix<double> &A, ub::vector<double> &E, ub::matrix<double> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues_symmetric");
 	gsl_error_handler_t *handler = gsl_set_error_handler_off();
 	const size_t N = A.size1();
         
@@ -68,6 +70,7 @@ bool linalg_eigenvalues_symmetric( ub::symmetric_matrix<double> &A, ub::vector<d
 */
 bool linalg_eigenvalues( ub::matrix<double> &A, ub::vector<double> &E, ub::matrix<double> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues");
 	gsl_error_handler_t *handler = gsl_set_error_handler_off();
 	const size_t N = A.size1();
         
@@ -99,6 +102,7 @@ bool linalg_eigenvalues( ub::matrix<double> &A, ub::vector<double> &E, ub::matri
 */
 bool linalg_eigenvalues( ub::matrix<float> &A, ub::vector<float> &E, ub::matrix<float> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues");
 	gsl_error_handler_t *handler = gsl_set_error_handler_off();
 	const size_t N = A.size1();
         
@@ -127,6 +131,7 @@ bool linalg_eigenvalues( ub::matrix<float> &A, ub::vector<float> &E, ub::matrix<
 
 bool linalg_eigenvalues(  ub::vector<float> &E, ub::matrix<float> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues");
         /* on input V is the matrix that shall be diagonalized
          * GSL does not provide an in-place routine, so we wrap 
          * gsl_eigen_symmv for compatibility
@@ -150,6 +155,7 @@ bool linalg_eigenvalues(  ub::vector<float> &E, ub::matrix<float> &V)
 */
 bool linalg_eigenvalues( ub::vector<double> &E, ub::matrix<double> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues");
         /* on input V is the matrix that shall be diagonalized
          * GSL does not provide an in-place routine, so we wrap 
          * gsl_eigen_symmv for compatibility
@@ -170,6 +176,7 @@ bool linalg_eigenvalues( ub::vector<double> &E, ub::matrix<double> &V)
  */
 bool linalg_eigenvalues( ub::matrix<double> &A, ub::vector<double> &E, ub::matrix<double> &V , int nmax)
 {
+    ScopedTimer timer("linalg_eigenvalues");
     throw std::runtime_error("linalg_eigenvalues is not compiled-in due to disabling of MKL - recompile Votca Tools with MKL support");
 }
 
@@ -178,6 +185,7 @@ bool linalg_eigenvalues( ub::matrix<double> &A, ub::vector<double> &E, ub::matri
  */
 bool linalg_eigenvalues( ub::matrix<float> &A, ub::vector<float> &E, ub::matrix<float> &V , int nmax)
 {
+    ScopedTimer timer("linalg_eigenvalues");
     // now call wrapper for gsl_eigen_symmv
     bool status = linalg_eigenvalues( A , E, V );
 
@@ -186,6 +194,7 @@ bool linalg_eigenvalues( ub::matrix<float> &A, ub::vector<float> &E, ub::matrix<
 
 bool linalg_eigenvalues_general( ub::matrix<double> &A,ub::matrix<double> &B, ub::vector<double> &E, ub::matrix<double> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues_general");
 	gsl_error_handler_t *handler = gsl_set_error_handler_off();
 	const size_t N = A.size1();
         
@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include <gsl/gsl_linalg.h>
@@ -28,6 +29,7 @@ using namespace std;
 
 
 void linalg_invert( ub::matrix<double> &A, ub::matrix<double> &V){
+    ScopedTimer timer("linalg_invert");
         // matrix inversion using gsl
         
         gsl_error_handler_t *handler = gsl_set_error_handler_off();
@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include <gsl/gsl_linalg.h>
@@ -30,6 +31,7 @@ using namespace std;
 
 void linalg_qrsolve(ub::vector<double> &x, ub::matrix<double> &A, ub::vector<double> &b, ub::vector<double> *residual)
 {
+    ScopedTimer timer("linalg_qrsolve");
     // check matrix for zero column
     int nonzero_found = 0;
     for(size_t j=0; j<A.size2(); j++) {
@@ -72,6 +74,7 @@ void linalg_qrsolve(ub::vector<double> &x, ub::matrix<double> &A, ub::vector<dou
 
 void linalg_constrained_qrsolve(ub::vector<double> &x, ub::matrix<double> &A, ub::vector<double> &b, ub::matrix<double> &constr)
 {
+    ScopedTimer timer("linalg_constrained_qrsolve");
     // check matrix for zero column
     int nonzero_found = 0;
     for(size_t j=0; j<A.size2(); j++) {
@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include <gsl/gsl_linalg.h>
@@ -42,6 +43,7 @@ using namespace std;
  */
 bool linalg_singular_value_decomposition( ub::matrix<double> &A, ub::matrix<double> &V, ub::vector<double> &S )
 {
+    ScopedTimer timer("linalg_singular_value_decomposition");
 	/*
         gsl_error_handler_t *handler = gsl_set_error_handler_off();
 	const size_t N = A.size1();
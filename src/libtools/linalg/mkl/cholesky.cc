@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include "mkl.h"
@@ -28,6 +29,7 @@ using namespace std;
 
 
 void linalg_cholesky_decompose( ub::matrix<double> &A){
+    ScopedTimer timer("linalg_cholesky_decompose");
     // Cholesky decomposition using MKL
     // input matrix A will be changed
 
@@ -47,6 +49,7 @@ void linalg_cholesky_decompose( ub::matrix<double> &A){
 
 
 void linalg_cholesky_solve( ub::vector<double> &x, ub::matrix<double> &A, ub::vector<double> &b ){
+    ScopedTimer timer("linalg_cholesky_solve");
     /* calling program should catch the error error code
      * thrown by LAPACKE_dpotrf and take
      * necessary steps
@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include "mkl.h"
@@ -34,6 +35,7 @@ using namespace std;
 
 bool linalg_eigenvalues( ub::matrix<double> &A, ub::vector<double> &E, ub::matrix<double> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues");
     // cout << " \n I'm really using MKL! " << endl;
     
     int n = A.size1();
@@ -70,6 +72,7 @@ bool linalg_eigenvalues( ub::matrix<double> &A, ub::vector<double> &E, ub::matri
 
 bool linalg_eigenvalues_symmetric( ub::symmetric_matrix<double> &A, ub::vector<double> &E, ub::matrix<double> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues_symmetric");
     // cout << " \n I'm really using MKL! " << endl;
     
     int n = A.size1();
@@ -104,6 +107,7 @@ bool linalg_eigenvalues_symmetric( ub::symmetric_matrix<double> &A, ub::vector<d
 
 bool linalg_eigenvalues(  ub::vector<double> &E, ub::matrix<double> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues");
     // cout << " \n I'm really using MKL! " << endl;
     
     int n = V.size1();
@@ -139,6 +143,7 @@ bool linalg_eigenvalues(  ub::vector<double> &E, ub::matrix<double> &V)
 
 bool linalg_eigenvalues(  ub::vector<float> &E, ub::matrix<float> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues");
     // cout << " \n I'm really using MKL! " << endl;
     
     int n = V.size1();
@@ -178,6 +183,7 @@ bool linalg_eigenvalues(  ub::vector<float> &E, ub::matrix<float> &V)
  */
 bool linalg_eigenvalues( ub::matrix<double> &A, ub::vector<double> &E, ub::matrix<double> &V , int nmax)
 {
+    ScopedTimer timer("linalg_eigenvalues");
     /*
      * INPUT:  matrix A (N,N)
      * OUTPUT: matrix V (N,NMAX)
@@ -232,6 +238,7 @@ bool linalg_eigenvalues( ub::matrix<double> &A, ub::vector<double> &E, ub::matri
  */
 bool linalg_eigenvalues( ub::matrix<float> &A, ub::vector<float> &E, ub::matrix<float> &V , int nmax)
 {
+    ScopedTimer timer("linalg_eigenvalues");
     /*
      * INPUT:  matrix A (N,N)
      * OUTPUT: matrix V (N,NMAX)
@@ -284,6 +291,7 @@ bool linalg_eigenvalues( ub::matrix<float> &A, ub::vector<float> &E, ub::matrix<
 /* calculate the eigenvalues and vectors of the generalized eigenvalue problem */
 bool linalg_eigenvalues_general( ub::matrix<double> &A,ub::matrix<double> &B, ub::vector<double> &E, ub::matrix<double> &V)
 {
+    ScopedTimer timer("linalg_eigenvalues_general");
     // cout << " \n I'm really using MKL! " << endl;
     //check to see if matrices have same size
     int n = A.size1();
@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include "mkl.h"
@@ -27,6 +28,7 @@ using namespace std;
 
 
 void linalg_invert( ub::matrix<double> &A, ub::matrix<double> &V){
+    ScopedTimer timer("linalg_invert");
     // matrix inversion using MKL
     // input matrix is destroyed, make local copy
     ub::matrix<double> work = A;
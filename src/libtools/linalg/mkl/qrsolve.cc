@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linalg.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 #include "mkl.h"
@@ -27,6 +28,7 @@ using namespace std;
 
 
 void linalg_qrsolve(ub::vector<double> &x, ub::matrix<double> &A, ub::vector<double> &b, ub::vector<double> *residual){
+    ScopedTimer timer("linalg_qrsolve");
     // check matrix for zero column
     int nonzero_found = 0;
     for(size_t j=0; j<A.size2(); j++) {
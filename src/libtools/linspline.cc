@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/linspline.h>
+#include <votca/tools/profiler.h>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
@@ -28,6 +29,8 @@ using namespace std;
 
 void LinSpline::Interpolate(ub::vector<double> &x, ub::vector<double> &y)
 {
+    ScopedTimer timer("LinSpline::Interpolate");
+
     if(x.size() != y.size())
         throw std::invalid_argument("error in LinSpline::Interpolate : sizes of vectors x and y do not match");
 
@@ -62,6 +65,8 @@ void LinSpline::Interpolate(ub::vector<double> &x, ub::vector<double> &y)
 
 void LinSpline::Fit(ub::vector<double> &x, ub::vector<double> &y)
 {
+    ScopedTimer timer("LinSpline::Fit");
+
     if(x.size() != y.size())
         throw std::invalid_argument("error in LinSpline::Fit : sizes of vectors x and y do not match");
 
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/memstat.h>
+#include <votca/tools/mutex.h>
+#include <boost/format.hpp>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <stdio.h>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+namespace {
+
+struct record_t {
+    record_t() : _current(0), _peak(0) {}
+    size_t _current;
+    size_t _peak;
+};
+
+// function statics, counters might be constructed during static
+// initialization of other translation units
+Mutex &memstat_lock()
+{
+    static Mutex lock;
+    return lock;
+}
+
+vector<MemCounter *> &memstat_counters()
+{
+    static vector<MemCounter *> counters;
+    return counters;
+}
+
+map<string, record_t> &memstat_records()
+{
+    static map<string, record_t> records;
+    return records;
+}
+
+string format_bytes(double bytes)
+{
+    const char *units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+    int i = 0;
+    while(bytes >= 1024. && i < 4) {
+        bytes /= 1024.;
+        ++i;
+    }
+    return (boost::format("%.2f %s") % bytes % units[i]).str();
+}
+
+}
+
+MemCounter::MemCounter(const string &name)
+    : _name(name), _current(0), _peak(0), _allocations(0)
+{
+    MemStat::Register(this);
+}
+
+void MemCounter::Allocate(size_t bytes)
+{
+    long long current = __sync_add_and_fetch(&_current, (long long)bytes);
+    __sync_add_and_fetch(&_allocations, 1LL);
+    long long peak = _peak;
+    while(current > peak) {
+        long long old = __sync_val_compare_and_swap(&_peak, peak, current);
+        if(old == peak) break;
+        peak = old;
+    }
+}
+
+void MemCounter::Deallocate(size_t bytes)
+{
+    __sync_sub_and_fetch(&_current, (long long)bytes);
+}
+
+void MemCounter::Account(size_t &accounted, size_t bytes)
+{
+    if(bytes > accounted)
+        Allocate(bytes - accounted);
+    else if(bytes < accounted)
+        Deallocate(accounted - bytes);
+    accounted = bytes;
+}
+
+void MemStat::Register(MemCounter *counter)
+{
+    memstat_lock().Lock();
+    memstat_counters().push_back(counter);
+    memstat_lock().Unlock();
+}
+
+void MemStat::Record(const string &name, size_t bytes)
+{
+    memstat_lock().Lock();
+    record_t &r = memstat_records()[name];
+    r._current = bytes;
+    if(bytes > r._peak) r._peak = bytes;
+    memstat_lock().Unlock();
+}
+
+size_t MemStat::ResidentSize()
+{
+    long pages = 0, resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if(!f) return 0;
+    if(fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(f);
+    return (size_t)resident*sysconf(_SC_PAGESIZE);
+}
+
+size_t MemStat::PeakResidentSize()
+{
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    // kilobytes on Linux
+    return (size_t)usage.ru_maxrss*1024;
+#endif
+}
+
+void MemStat::Report(ostream &out)
+{
+    out << "================ memory usage ===================\n";
+    out << boost::format("%-40s %14s %14s\n") % "process" % "current" % "peak";
+    out << boost::format("%-40s %14s %14s\n") % "resident set size"
+        % format_bytes(ResidentSize()) % format_bytes(PeakResidentSize());
+
+    memstat_lock().Lock();
+    map<string, record_t> &records = memstat_records();
+    if(!records.empty()) {
+        size_t total = 0;
+        out << boost::format("\n%-40s %14s %14s\n") % "data structure" % "current" % "peak";
+        for(map<string, record_t>::iterator iter = records.begin(); iter != records.end(); ++iter) {
+            out << boost::format("%-40s %14s %14s\n") % iter->first
+                % format_bytes(iter->second._current) % format_bytes(iter->second._peak);
+            total += iter->second._current;
+        }
+        out << boost::format("%-40s %14s\n") % "total" % format_bytes(total);
+    }
+
+    vector<MemCounter *> &counters = memstat_counters();
+    bool header = false;
+    for(size_t i=0; i<counters.size(); ++i) {
+        MemCounter *c = counters[i];
+        if(c->getAllocations() == 0) continue;
+        if(!header) {
+            out << boost::format("\n%-40s %14s %14s %12s\n") % "counter" % "current" % "peak" % "allocations";
+            header = true;
+        }
+        out << boost::format("%-40s %14s %14s %12d\n") % c->getName()
+            % format_bytes(c->getCurrent()) % format_bytes(c->getPeak()) % c->getAllocations();
+    }
+    memstat_lock().Unlock();
+    out << "=================================================\n";
+}
+
+}}
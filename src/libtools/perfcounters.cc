@@ -0,0 +1,102 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/perfcounters.h>
+#include <votca_config.h>
+#include <string.h>
+
+#ifdef HAVE_PERF_EVENT
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace votca { namespace tools {
+
+#ifdef HAVE_PERF_EVENT
+static int open_counter(unsigned long long config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    // only user space, this works with the default perf_event_paranoid
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid 0, cpu -1: calling thread on any cpu
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+PerfCounters::PerfCounters()
+{
+    for(int i=0; i<NumCounters; ++i)
+        _fd[i] = -1;
+#ifdef HAVE_PERF_EVENT
+    _fd[Cycles] = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+    _fd[Instructions] = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+    _fd[CacheMisses] = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+    _fd[BranchMisses] = open_counter(PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef HAVE_PERF_EVENT
+    for(int i=0; i<NumCounters; ++i)
+        if(_fd[i] >= 0) close(_fd[i]);
+#endif
+}
+
+bool PerfCounters::AnyAvailable() const
+{
+    for(int i=0; i<NumCounters; ++i)
+        if(Available(i)) return true;
+    return false;
+}
+
+void PerfCounters::Read(unsigned long long *values) const
+{
+    for(int i=0; i<NumCounters; ++i) {
+        values[i] = 0;
+#ifdef HAVE_PERF_EVENT
+        if(_fd[i] < 0) continue;
+        // value, time enabled, time running
+        unsigned long long data[3];
+        if(read(_fd[i], data, sizeof(data)) != sizeof(data)) continue;
+        if(data[2] > 0 && data[2] < data[1])
+            values[i] = (unsigned long long)((double)data[0]*data[1]/data[2]);
+        else
+            values[i] = data[0];
+#endif
+    }
+}
+
+const char *PerfCounters::Name(int counter)
+{
+    switch(counter) {
+        case Cycles: return "cycles";
+        case Instructions: return "instructions";
+        case CacheMisses: return "cache-misses";
+        case BranchMisses: return "branch-misses";
+    }
+    return "unknown";
+}
+
+}}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/plugin.h>
+#include <votca/tools/property.h>
+#include <votca/tools/tokenizer.h>
+#include <votca/tools/mutex.h>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <dlfcn.h>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+namespace {
+
+Mutex &plugin_lock()
+{
+    static Mutex lock;
+    return lock;
+}
+
+// handles of the loaded libraries, they are never closed
+map<string, void *> &libraries()
+{
+    static map<string, void *> handles;
+    return handles;
+}
+
+}
+
+void *Plugin::Load(const string &library)
+{
+    plugin_lock().Lock();
+    map<string, void *>::iterator iter = libraries().find(library);
+    if(iter != libraries().end()) {
+        void *handle = iter->second;
+        plugin_lock().Unlock();
+        return handle;
+    }
+
+    // RTLD_GLOBAL: plugins may depend on each other
+    void *handle = dlopen(library.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    if(handle == NULL) {
+        string error = dlerror();
+        plugin_lock().Unlock();
+        throw runtime_error("cannot load plugin " + library + ": " + error);
+    }
+    libraries()[library] = handle;
+    plugin_lock().Unlock();
+    return handle;
+}
+
+bool Plugin::IsLoaded(const string &library)
+{
+    plugin_lock().Lock();
+    bool loaded = libraries().find(library) != libraries().end();
+    plugin_lock().Unlock();
+    return loaded;
+}
+
+void *Plugin::Symbol(const string &library, const string &symbol)
+{
+    void *handle = Load(library);
+    plugin_lock().Lock();
+    dlerror();
+    void *address = dlsym(handle, symbol.c_str());
+    const char *error = dlerror();
+    string message = error ? error : "";
+    plugin_lock().Unlock();
+    if(error)
+        throw runtime_error("symbol " + symbol + " not found in plugin " + library + ": " + message);
+    return address;
+}
+
+void Plugin::ReadManifest(const string &filename, vector<Entry> &entries)
+{
+    Property manifest;
+    load_property_from_xml(manifest, filename);
+
+    string dir;
+    string::size_type slash = filename.rfind('/');
+    if(slash != string::npos)
+        dir = filename.substr(0, slash + 1);
+
+    const Property &root = manifest;
+    list<const Property *> plugins = root.Select("plugins.plugin");
+    for(list<const Property *>::iterator p = plugins.begin(); p != plugins.end(); ++p) {
+        if(!(*p)->hasAttribute("library"))
+            throw runtime_error(filename + ": plugin without library");
+        string library = (*p)->getAttribute<string>("library");
+        // dlopen searches the library path for names without a slash
+        if(library.find('/') == string::npos) {
+            string local = dir + library;
+            if(!dir.empty() && access(local.c_str(), F_OK) == 0)
+                library = local;
+        }
+        else if(library[0] != '/')
+            library = dir + library;
+
+        string factory;
+        if((*p)->hasAttribute("factory"))
+            factory = (*p)->getAttribute<string>("factory");
+
+        list<const Property *> objects = (*p)->Select("object");
+        for(list<const Property *>::iterator o = objects.begin(); o != objects.end(); ++o) {
+            Entry entry;
+            if(!(*o)->hasAttribute("key"))
+                throw runtime_error(filename + ": object without key in plugin " + library);
+            entry._key = (*o)->getAttribute<string>("key");
+            entry._library = library;
+            entry._factory = factory;
+            if((*o)->hasAttribute("create"))
+                entry._create = (*o)->getAttribute<string>("create");
+            entries.push_back(entry);
+        }
+    }
+}
+
+vector<string> Plugin::FindManifests(const string &path)
+{
+    vector<string> manifests;
+    Tokenizer tok(path, ":");
+    for(Tokenizer::iterator dir = tok.begin(); dir != tok.end(); ++dir) {
+        DIR *d = opendir((*dir).c_str());
+        if(d == NULL) continue;
+        vector<string> files;
+        struct dirent *e;
+        while((e = readdir(d)) != NULL) {
+            string name = e->d_name;
+            if(name.size() > 4 && name.compare(name.size() - 4, 4, ".xml") == 0)
+                files.push_back(*dir + "/" + name);
+        }
+        closedir(d);
+        sort(files.begin(), files.end());
+        manifests.insert(manifests.end(), files.begin(), files.end());
+    }
+    return manifests;
+}
+
+}}
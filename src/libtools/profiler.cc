@@ -0,0 +1,267 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/profiler.h>
+#include <votca/tools/mutex.h>
+#include <boost/format.hpp>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <map>
+#include <algorithm>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+bool Profiler::_enabled = false;
+bool Profiler::_counters_enabled = false;
+
+Profiler::Node::~Node()
+{
+    for(size_t i=0; i<_childs.size(); ++i)
+        delete _childs[i];
+}
+
+Profiler::Node *Profiler::Node::Child(const char *name)
+{
+    // the number of childs is small, a linear search is faster than a map
+    for(size_t i=0; i<_childs.size(); ++i)
+        if(strcmp(_childs[i]->_name.c_str(), name) == 0)
+            return _childs[i];
+    _childs.push_back(new Node(name, this));
+    return _childs.back();
+}
+
+namespace {
+
+/// profiling data of one thread
+struct ThreadProfile {
+    ThreadProfile() : _root("root", NULL), _current(&_root), _perf(NULL) {}
+    Profiler::Node _root;
+    Profiler::Node *_current;
+    /// hardware counters of this thread, opened on first use
+    PerfCounters *_perf;
+
+    PerfCounters *Counters() {
+        if(!_perf) _perf = new PerfCounters();
+        return _perf;
+    }
+};
+
+pthread_key_t profile_key;
+pthread_once_t profile_key_once = PTHREAD_ONCE_INIT;
+
+// the trees of the running threads
+Mutex profiles_lock;
+vector<ThreadProfile *> profiles;
+// merged trees of the threads which have exited, so that the report
+// contains the whole run while pool threads come and go
+Profiler::Node retired("root", NULL);
+int retired_threads = 0;
+bool retired_available[PerfCounters::NumCounters] = { false };
+
+void merge_node(Profiler::Node &merged, const Profiler::Node &node);
+
+// called when a thread exits, closes its counters
+void release_profile(void *data)
+{
+    ThreadProfile *tp = (ThreadProfile *)data;
+    profiles_lock.Lock();
+    merge_node(retired, tp->_root);
+    if(tp->_perf)
+        for(int j=0; j<PerfCounters::NumCounters; ++j)
+            retired_available[j] = retired_available[j] || tp->_perf->Available(j);
+    ++retired_threads;
+    profiles.erase(find(profiles.begin(), profiles.end(), tp));
+    profiles_lock.Unlock();
+    delete tp->_perf;
+    delete tp;
+}
+
+void create_profile_key()
+{
+    pthread_key_create(&profile_key, release_profile);
+}
+
+ThreadProfile *thread_profile()
+{
+    pthread_once(&profile_key_once, create_profile_key);
+    ThreadProfile *tp = (ThreadProfile *)pthread_getspecific(profile_key);
+    if(!tp) {
+        tp = new ThreadProfile();
+        pthread_setspecific(profile_key, tp);
+        profiles_lock.Lock();
+        profiles.push_back(tp);
+        profiles_lock.Unlock();
+    }
+    return tp;
+}
+
+/// add the data of a thread tree to the merged tree
+void merge_node(Profiler::Node &merged, const Profiler::Node &node)
+{
+    merged._calls += node._calls;
+    merged._count += node._count;
+    merged._time += node._time;
+    for(int i=0; i<PerfCounters::NumCounters; ++i)
+        merged._counters[i] += node._counters[i];
+    for(size_t i=0; i<node._childs.size(); ++i)
+        merge_node(*merged.Child(node._childs[i]->_name.c_str()), *node._childs[i]);
+}
+
+void print_node(ostream &out, const Profiler::Node &node, double parent_time, int level)
+{
+    string name = string(2*level, ' ') + node._name;
+    if(node._calls > 0) {
+        double percent = parent_time > 0 ? 100.*node._time/parent_time : 100.;
+        out << boost::format("%-40s %10d %12.6f %12.6f %7.2f%%")
+            % name % node._calls % node._time % (node._time/node._calls) % percent;
+    }
+    else
+        out << boost::format("%-40s %10s %12s %12s %8s") % name % "-" % "-" % "-" % "-";
+    if(node._count > 0)
+        out << " " << node._count;
+    out << endl;
+
+    double time = node._calls > 0 ? node._time : parent_time;
+    for(size_t i=0; i<node._childs.size(); ++i)
+        print_node(out, *node._childs[i], time, level+1);
+}
+
+void print_counters(ostream &out, const Profiler::Node &node, const bool *available, int level)
+{
+    string name = string(2*level, ' ') + node._name;
+    out << boost::format("%-40s") % name;
+    for(int i=0; i<PerfCounters::NumCounters; ++i) {
+        if(available[i]) out << boost::format(" %14d") % node._counters[i];
+        else out << boost::format(" %14s") % "n/a";
+    }
+    if(available[PerfCounters::Cycles] && available[PerfCounters::Instructions]
+            && node._counters[PerfCounters::Cycles] > 0)
+        out << boost::format(" %6.2f") % ((double)node._counters[PerfCounters::Instructions]
+                / node._counters[PerfCounters::Cycles]);
+    out << endl;
+
+    for(size_t i=0; i<node._childs.size(); ++i)
+        print_counters(out, *node._childs[i], available, level+1);
+}
+
+}
+
+double Profiler::Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+void Profiler::Start(const char *name)
+{
+    ThreadProfile *tp = thread_profile();
+    Node *node = tp->_current->Child(name);
+    tp->_current = node;
+    node->_start = Now();
+    if(_counters_enabled)
+        tp->Counters()->Read(node->_counters_start);
+}
+
+void Profiler::Stop()
+{
+    ThreadProfile *tp = thread_profile();
+    Node *node = tp->_current;
+    // unbalanced Stop, e.g. profiling was switched on inside a region
+    if(node->_parent == NULL) return;
+    if(_counters_enabled) {
+        unsigned long long values[PerfCounters::NumCounters];
+        tp->Counters()->Read(values);
+        for(int i=0; i<PerfCounters::NumCounters; ++i)
+            node->_counters[i] += values[i] - node->_counters_start[i];
+    }
+    node->_time += Now() - node->_start;
+    node->_calls++;
+    tp->_current = node->_parent;
+}
+
+void Profiler::Count(const char *name, unsigned long n)
+{
+    if(!_enabled) return;
+    ThreadProfile *tp = thread_profile();
+    tp->_current->Child(name)->_count += n;
+}
+
+void Profiler::Report(ostream &out)
+{
+    Node merged("root", NULL);
+    bool available[PerfCounters::NumCounters] = { false };
+    profiles_lock.Lock();
+    merge_node(merged, retired);
+    for(int j=0; j<PerfCounters::NumCounters; ++j)
+        available[j] = retired_available[j];
+    for(size_t i=0; i<profiles.size(); ++i) {
+        merge_node(merged, profiles[i]->_root);
+        if(profiles[i]->_perf)
+            for(int j=0; j<PerfCounters::NumCounters; ++j)
+                available[j] = available[j] || profiles[i]->_perf->Available(j);
+    }
+    int nthreads = profiles.size() + retired_threads;
+    profiles_lock.Unlock();
+
+    out << "==================== profile ====================\n";
+    out << "threads: " << nthreads << endl;
+    out << boost::format("%-40s %10s %12s %12s %8s %s\n")
+        % "region" % "calls" % "total [s]" % "avg [s]" % "parent" % "count";
+    for(size_t i=0; i<merged._childs.size(); ++i)
+        print_node(out, *merged._childs[i], 0, 0);
+
+    if(_counters_enabled) {
+        out << "\nhardware counters";
+        bool any = false;
+        for(int j=0; j<PerfCounters::NumCounters; ++j) any = any || available[j];
+        if(!any)
+            out << " are not available (not supported or no permission, see /proc/sys/kernel/perf_event_paranoid)";
+        out << ":\n" << boost::format("%-40s") % "region";
+        for(int j=0; j<PerfCounters::NumCounters; ++j)
+            out << boost::format(" %14s") % PerfCounters::Name(j);
+        out << boost::format(" %6s\n") % "IPC";
+        for(size_t i=0; i<merged._childs.size(); ++i)
+            print_counters(out, *merged._childs[i], available, 0);
+    }
+    out << "=================================================\n";
+}
+
+void Profiler::Clear()
+{
+    profiles_lock.Lock();
+    for(size_t i=0; i<profiles.size(); ++i) {
+        Node &root = profiles[i]->_root;
+        // only clear closed regions, open ones are still referenced
+        if(profiles[i]->_current != &root) continue;
+        for(size_t j=0; j<root._childs.size(); ++j)
+            delete root._childs[j];
+        root._childs.clear();
+    }
+    for(size_t j=0; j<retired._childs.size(); ++j)
+        delete retired._childs[j];
+    retired._childs.clear();
+    retired_threads = 0;
+    for(int j=0; j<PerfCounters::NumCounters; ++j)
+        retired_available[j] = false;
+    profiles_lock.Unlock();
+}
+
+}}
@@ -24,11 +24,14 @@
 #include <string>
 #include <stack>
 #include <iomanip>
+#include <algorithm>
 
 #include <votca/tools/property.h>
 #include <votca/tools/colors.h>
 #include <votca/tools/tokenizer.h>
 #include <votca/tools/propertyiomanipulator.h>
+#include <votca/tools/memstat.h>
+#include <votca/tools/threadpool.h>
 
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
@@ -38,46 +41,195 @@ namespace votca { namespace tools {
 
 // ostream modifier defines the output format, level, indentation
 const int Property::IOindex = std::ios_base::xalloc(); 
+
+Property::Property(const Property &p)
+    : _parent(NULL), _attributes(p._attributes), _properties(p._properties), _value(p._value),
+      _name(p._name), _path(p._path)
+{
+    // _map points to the last child with a given name
+    for(list<Property>::iterator iter = _properties.begin(); iter != _properties.end(); ++iter) {
+        iter->_parent = this;
+        _map[iter->_name] = &(*iter);
+    }
+}
+
+Property &Property::operator=(const Property &p)
+{
+    if(this == &p) return *this;
+    Property tmp(p);
+    SwapContents(tmp);
+    _name = p._name;
+    _path = p._path;
+    // an index stays with the node, it is rebuilt for the new content
+    if(_index) _index->_stale = true;
+    if(_parent) _parent->Invalidate();
+    return *this;
+}
+
+void Property::SwapContents(Property &p)
+{
+    // list::swap keeps the nodes, so _map stays valid
+    _map.swap(p._map);
+    _attributes.swap(p._attributes);
+    _properties.swap(p._properties);
+    _value.swap(p._value);
+    for(list<Property>::iterator iter = _properties.begin(); iter != _properties.end(); ++iter)
+        iter->_parent = this;
+    for(list<Property>::iterator iter = p._properties.begin(); iter != p._properties.end(); ++iter)
+        iter->_parent = &p;
+}
+
+void Property::swap(Property &p)
+{
+    // a child is listed under its name in the parent, exchanging it with
+    // another tree would leave the parent pointing at the wrong content
+    if(_parent != NULL || p._parent != NULL)
+        throw runtime_error("Property::swap: only root nodes can be swapped, " + _path + "." + _name);
+    SwapContents(p);
+    // the indices moved with the subtrees
+    _index.swap(p._index);
+}
+
+void Property::Invalidate()
+{
+    for(Property *node = this; node; node = node->_parent)
+        if(node->_index)
+            node->_index->_stale = true;
+}
+
+void Property::AddToIndex(Property *child, Property *hidden)
+{
+    // most trees have no index at all
+    Property *node = this;
+    while(node && !node->_index)
+        node = node->_parent;
+    if(!node) return;
+
+    string path = child->_name;
+    // path from the indexed node leads to child when walking the tree
+    bool visible = true;
+    // child is the last node in document order
+    bool last = true;
+    for(node = this; node; node = node->_parent) {
+        PathIndex *index = node->_index.get();
+        if(index && !index->_stale) {
+            if(visible && hidden)
+                index->Hide(hidden, path);
+            index->Insert(child, path, visible);
+            if(!last)
+                index->_ordered = false;
+        }
+        Property *parent = node->_parent;
+        if(!parent) break;
+        map<string, Property *>::iterator found = parent->_map.find(node->_name);
+        visible = visible && found != parent->_map.end() && found->second == node;
+        last = last && &parent->_properties.back() == node;
+        path = node->_name + "." + path;
+    }
+}
+
+boost::shared_ptr<const Property> Property::Freeze()
+{
+    if(_parent != NULL)
+        throw runtime_error("Property::Freeze: only a root node can be frozen, " + _path + "." + _name);
+    boost::shared_ptr<Property> p(new Property(_name, "", _path));
+    p->swap(*this);
+    return p;
+}
+
+// keys the index can answer, everything else is resolved by walking the tree
+static bool is_plain_path(const string &key)
+{
+    return !key.empty() && key[0] != '.' && key[key.size() - 1] != '.'
+        && key.find("..") == string::npos;
+}
    
 Property &Property::get(const string &key)
 {
-    Tokenizer tok(key, ".");
-    Tokenizer::iterator n;
-    
-    n = tok.begin();
-    if(n==tok.end()) return *this;
-    
-    Property *p;
-    map<string, Property*>::iterator iter;
-    if(*n=="") {
-        p = this;
-    }
-    else {
-        iter = _map.find(*n);
-    
-        if(iter == _map.end())
-            throw runtime_error("property not found: " + key);
-    
-        p = (((*iter).second));
+    Property *p = find(key);
+    if(p == NULL)
+        throw runtime_error("property not found: " + key);
+    return *p;
+}
+
+const Property &Property::get(const string &key) const
+{
+    const Property *p = find(key);
+    if(p == NULL)
+        throw runtime_error("property not found: " + key);
+    return *p;
+}
+
+Property *Property::find(const string &key)
+{
+    if(_index && is_plain_path(key)) {
+        PathIndex *index = Index();
+        if(index) {
+            boost::unordered_map<string, Property *>::iterator iter = index->_lookup.find(key);
+            return iter == index->_lookup.end() ? NULL : iter->second;
+        }
     }
-    ++n;
-    try {
-        for(; n!=tok.end(); ++n) {
-            p = &p->get(*n);
+
+    Property *p = this;
+    string::size_type start = 0;
+    // step down the hierarchy without creating tokens or exceptions
+    while(start <= key.size()) {
+        string::size_type end = key.find('.', start);
+        if(end == string::npos) end = key.size();
+        if(end > start) {
+            map<string, Property*>::iterator iter = p->_map.find(key.substr(start, end - start));
+            if(iter == p->_map.end())
+                return NULL;
+            p = iter->second;
         }
+        start = end + 1;
     }
-    catch(string err) { // catch here to get full key in exception
-        throw runtime_error("property not found: " + key);
+    return p;
+}
+
+const Property *Property::find(const string &key) const
+{
+    const PathIndex *index;
+    if(_index && is_plain_path(key) && (index = ValidIndex())) {
+        boost::unordered_map<string, Property *>::const_iterator iter = index->_lookup.find(key);
+        return iter == index->_lookup.end() ? NULL : iter->second;
     }
-    
-    return *p;
+
+    const Property *p = this;
+    string::size_type start = 0;
+    while(start <= key.size()) {
+        string::size_type end = key.find('.', start);
+        if(end == string::npos) end = key.size();
+        if(end > start) {
+            map<string, Property*>::const_iterator iter = p->_map.find(key.substr(start, end - start));
+            if(iter == p->_map.end())
+                return NULL;
+            p = iter->second;
+        }
+        start = end + 1;
+    }
+    return p;
 }
 
 std::list<Property *> Property::Select(const string &filter)
 {
-    Tokenizer tok(filter, ".");
-    
     std::list<Property *> selection;
+    if(_index) {
+        // nodes added out of document order have no valid position
+        if(!_index->_ordered)
+            _index->_stale = true;
+        PathIndex *index = Index();
+        if(index) {
+            if(!index->_sorted) {
+                std::sort(index->_entries.begin(), index->_entries.end());
+                index->_sorted = true;
+            }
+            IndexSelect(index, filter, selection);
+            return selection;
+        }
+    }
+
+    Tokenizer tok(filter, ".");
 
     if(tok.begin()==tok.end()) return selection;
     
@@ -85,12 +237,47 @@ std::list<Property *> Property::Select(const string &filter)
         
     for (Tokenizer::iterator n = tok.begin();
             n != tok.end(); ++n) {
+        WildcardMatcher matcher(*n);
         std::list<Property *> childs;
         for (std::list<Property *>::iterator p = selection.begin();
                 p != selection.end(); ++p) {
-                for (list<Property>::iterator iter = (*p)->_properties.begin();
-                    iter != (*p)->_properties.end(); ++iter) {
-                    if (wildcmp((*n).c_str(), (*iter).name().c_str())) {
+                for (list<Property>::iterator iter = (*p)->begin();
+                    iter != (*p)->end(); ++iter) {
+                    if (matcher.Match((*iter)._name)) {
+                        childs.push_back(&(*iter));
+                    }
+                }
+        }
+        selection = childs;        
+    }
+
+    return selection;
+}
+
+std::list<const Property *> Property::Select(const string &filter) const
+{
+    std::list<const Property *> selection;
+    const PathIndex *index;
+    if(_index && (index = ValidIndex()) && index->_sorted && index->_ordered) {
+        IndexSelect(index, filter, selection);
+        return selection;
+    }
+
+    Tokenizer tok(filter, ".");
+
+    if(tok.begin()==tok.end()) return selection;
+    
+    selection.push_back(this);
+        
+    for (Tokenizer::iterator n = tok.begin();
+            n != tok.end(); ++n) {
+        WildcardMatcher matcher(*n);
+        std::list<const Property *> childs;
+        for (std::list<const Property *>::iterator p = selection.begin();
+                p != selection.end(); ++p) {
+                for (list<Property>::const_iterator iter = (*p)->begin();
+                    iter != (*p)->end(); ++iter) {
+                    if (matcher.Match((*iter)._name)) {
                         childs.push_back(&(*iter));
                     }
                 }
@@ -101,6 +288,127 @@ std::list<Property *> Property::Select(const string &filter)
     return selection;
 }
 
+template<typename P>
+void Property::IndexSelect(const PathIndex *index, const string &filter, std::list<P> &selection)
+{
+    vector<string> tokens;
+    Tokenizer tok(filter, ".");
+    tok.ToVector(tokens);
+    if(tokens.empty()) return;
+
+    // all matches start with the filter up to the first wildcard
+    string pattern = boost::algorithm::join(tokens, ".");
+    string prefix = pattern.substr(0, pattern.find_first_of("*?"));
+
+    PathIndex::entry_t first;
+    first._path = prefix;
+    first._order = 0;
+    vector<PathIndex::entry_t>::const_iterator iter =
+        std::lower_bound(index->_entries.begin(), index->_entries.end(), first);
+
+    vector<WildcardMatcher> matchers(tokens.size());
+    for(size_t i = 0; i < tokens.size(); ++i)
+        matchers[i].Compile(tokens[i]);
+
+    vector<pair<size_t, Property *> > matches;
+    vector<string> names;
+    for(; iter != index->_entries.end() && iter->_path.compare(0, prefix.size(), prefix) == 0; ++iter) {
+        if(std::count(iter->_path.begin(), iter->_path.end(), '.') + 1 != (int)tokens.size())
+            continue;
+        names.clear();
+        boost::algorithm::split(names, iter->_path, boost::algorithm::is_any_of("."));
+        size_t i;
+        for(i = 0; i < tokens.size(); ++i)
+            if(!matchers[i].Match(names[i])) break;
+        if(i == tokens.size())
+            matches.push_back(make_pair(iter->_order, iter->_node));
+    }
+
+    // same order as walking the tree level by level
+    std::sort(matches.begin(), matches.end());
+    for(vector<pair<size_t, Property *> >::iterator m = matches.begin(); m != matches.end(); ++m)
+        selection.push_back(m->second);
+}
+
+void Property::EnableIndex(bool enable)
+{
+    if(!enable) {
+        _index.reset();
+        return;
+    }
+    if(!_index) {
+        _index.reset(new PathIndex());
+        // force a build
+        _index->_stale = true;
+    }
+    Index();
+}
+
+Property::PathIndex *Property::Index()
+{
+    PathIndex *index = _index.get();
+    if(index->_stale) {
+        index->_lookup.clear();
+        index->_entries.clear();
+        index->_plain = true;
+        index->Build(this, "", true);
+        std::sort(index->_entries.begin(), index->_entries.end());
+        index->_sorted = true;
+        index->_ordered = true;
+        index->_stale = false;
+    }
+    return index->_plain ? index : NULL;
+}
+
+const Property::PathIndex *Property::ValidIndex() const
+{
+    const PathIndex *index = _index.get();
+    if(index->_stale || !index->_plain)
+        return NULL;
+    return index;
+}
+
+void Property::PathIndex::Insert(Property *node, const string &path, bool visible)
+{
+    if(node->_name.empty() || node->_name.find('.') != string::npos)
+        _plain = false;
+    if(visible)
+        _lookup[path] = node;
+    entry_t entry;
+    entry._path = path;
+    entry._node = node;
+    entry._order = _entries.size();
+    _entries.push_back(entry);
+    _sorted = false;
+}
+
+void Property::PathIndex::Hide(Property *node, const string &path)
+{
+    _lookup.erase(path);
+    for(list<Property>::iterator iter = node->_properties.begin();
+            iter != node->_properties.end(); ++iter)
+        Hide(&(*iter), path + "." + iter->_name);
+}
+
+void Property::PathIndex::Build(Property *node, const string &path, bool visible)
+{
+    // an assigned child carries the name of its source, the walk still
+    // reaches it by its old name, which the index cannot describe
+    for(map<string, Property *>::iterator iter = node->_map.begin(); iter != node->_map.end(); ++iter)
+        if(iter->second->_name != iter->first)
+            _plain = false;
+    for(list<Property>::iterator iter = node->_properties.begin();
+            iter != node->_properties.end(); ++iter) {
+        Property *child = &(*iter);
+        string child_path = path.empty() ? child->_name : path + "." + child->_name;
+        // a path leads to the last child with a given name, as when walking the tree
+        map<string, Property *>::iterator found = node->_map.find(child->_name);
+        bool child_visible = visible && found != node->_map.end() && found->second == child;
+        Insert(child, child_path, child_visible);
+        Build(child, child_path, child_visible);
+    }
+}
+
 static void start_hndl(void *data, const char *el, const char **attr)
 {
     stack<Property *> *property_stack =
@@ -142,31 +450,122 @@ bool load_property_from_xml(Property &p, string filename)
   XML_SetCharacterDataHandler(parser, char_hndl);
 
   ifstream fl;
-  fl.open(filename.c_str());
-  if(!fl.is_open())
+  fl.open(filename.c_str(), ios::binary);
+  if(!fl.is_open()) {
+    XML_ParserFree(parser);
     throw std::ios_base::failure("Error on open xml file: " + filename);
+  }
 
   stack<Property *> pstack;
   pstack.push(&p);
 
   XML_SetUserData(parser, (void*)&pstack);
-  while(!fl.eof()) {
-    string line;
-    getline(fl, line);
-    line=line + "\n";
-    if (! XML_Parse(parser, line.c_str(), line.length(), fl.eof()))
-      throw  std::ios_base::failure(filename + ": Parse error at line " +
+  // parse in blocks, expat buffers incomplete tokens itself
+  const int block = 65536;
+  bool last = false;
+  while(!last) {
+    void *buffer = XML_GetBuffer(parser, block);
+    if(buffer == NULL) {
+      XML_ParserFree(parser);
+      throw std::runtime_error("Couldn't allocate memory for xml parser");
+    }
+    fl.read((char*)buffer, block);
+    int n = fl.gcount();
+    last = n < block;
+    if (! XML_ParseBuffer(parser, n, last)) {
+      string error = filename + ": Parse error at line " +
           boost::lexical_cast<string>(XML_GetCurrentLineNumber(parser)) + "\n" +
-          XML_ErrorString(XML_GetErrorCode(parser)));
+          XML_ErrorString(XML_GetErrorCode(parser));
+      XML_ParserFree(parser);
+      throw  std::ios_base::failure(error);
+    }
   }
   fl.close();
+  XML_ParserFree(parser);
   return true;
 }
 
-void PrintNodeTXT(std::ostream &out, Property &p, const int start_level, int level=0, string prefix="", string offset="")
+namespace {
+// loads one file for load_properties_from_xml
+class LoadXMLJob : public ThreadPool::Job {
+public:
+    LoadXMLJob(Property *p, const string &filename, string *error)
+        : _p(p), _filename(filename), _error(error) {}
+
+    void Run() {
+        try {
+            load_property_from_xml(*_p, _filename);
+        }
+        catch(std::exception &e) {
+            *_error = e.what();
+        }
+    }
+
+private:
+    Property *_p;
+    string _filename;
+    string *_error;
+};
+}
+
+// loads the files into the given trees
+static void load_xml_files(vector<Property> &properties, const vector<string> &filenames, int nthreads)
+{
+    vector<string> errors(filenames.size());
+
+    if(nthreads <= 0)
+        nthreads = ThreadPool::Processors();
+    if(nthreads > (int)filenames.size())
+        nthreads = filenames.size();
+
+    if(nthreads <= 1) {
+        for(size_t i = 0; i < filenames.size(); ++i)
+            LoadXMLJob(&properties[i], filenames[i], &errors[i]).Run();
+    }
+    else {
+        ThreadPool pool(nthreads);
+        for(size_t i = 0; i < filenames.size(); ++i)
+            pool.Submit(new LoadXMLJob(&properties[i], filenames[i], &errors[i]));
+        pool.Wait();
+    }
+
+    // report errors independent of the order the files were processed in
+    for(size_t i = 0; i < errors.size(); ++i)
+        if(!errors[i].empty())
+            throw std::runtime_error(errors[i]);
+}
+
+void load_properties_from_xml(vector<Property> &properties, const vector<string> &filenames, int nthreads)
+{
+    properties.assign(filenames.size(), Property());
+    load_xml_files(properties, filenames, nthreads);
+}
+
+void load_properties_from_xml(Property &p, const vector<string> &filenames, int nthreads)
+{
+    // load into nodes with the name and path of p, so the loaded
+    // nodes have the paths they get under p
+    vector<Property> properties;
+    for(size_t i = 0; i < filenames.size(); ++i)
+        properties.push_back(Property(p._name, "", p._path));
+    load_xml_files(properties, filenames, nthreads);
+
+    // move the loaded nodes, list::splice keeps them in place
+    for(size_t i = 0; i < properties.size(); ++i) {
+        list<Property> &loaded = properties[i]._properties;
+        while(!loaded.empty()) {
+            p._properties.splice(p._properties.end(), loaded, loaded.begin());
+            p._properties.back()._parent = &p;
+            p._map[p._properties.back()._name] = &p._properties.back();
+        }
+    }
+    p.Invalidate();
+}
+
+void PrintNodeTXT(std::ostream &out, const Property &p, const int start_level, int level=0, string prefix="", string offset="")
 {
     
-    list<Property>::iterator iter;
+    list<Property>::const_iterator iter;
         
     if((p.value() != "") || p.HasChilds() ) {
         
@@ -192,10 +591,10 @@ void PrintNodeTXT(std::ostream &out, Property &p, const int start_level, int lev
     
 }
 
-void PrintNodeXML(std::ostream &out, Property &p, PropertyIOManipulator *piom, int level=0, string offset="")
+void PrintNodeXML(std::ostream &out, const Property &p, PropertyIOManipulator *piom, int level=0, string offset="")
 {
-    list<Property>::iterator iter;       
-    Property::AttributeIterator ia;
+    list<Property>::const_iterator iter;       
+    Property::ConstAttributeIterator ia;
     bool _endl = true;
     bool has_value;
     
@@ -261,10 +660,10 @@ void PrintNodeXML(std::ostream &out, Property &p, PropertyIOManipulator *piom, i
         } 
 }
     
-void PrintNodeTEX(std::ostream &out, Property &p, PropertyIOManipulator *piom, int level=0, string prefix="") {
+void PrintNodeTEX(std::ostream &out, const Property &p, PropertyIOManipulator *piom, int level=0, string prefix="") {
 
     
-    list<Property>::iterator iter;       
+    list<Property>::const_iterator iter;       
     string head_name;
     string _label(""); // reference of the xml file in the manual
     string _section(""); // reference of the description section in the manual
@@ -339,9 +738,9 @@ void PrintNodeTEX(std::ostream &out, Property &p, PropertyIOManipulator *piom, i
     if ( level == start_level )  out << boost::format(footer_format) % _section % head_name;
 }
 
-void PrintNodeHLP(std::ostream &out, Property &p, const int start_level=0, int level=0, string prefix="",  string offset="") {
+void PrintNodeHLP(std::ostream &out, const Property &p, const int start_level=0, int level=0, string prefix="",  string offset="") {
      
-    list<Property>::iterator iter;       
+    list<Property>::const_iterator iter;       
     string head_name;
     string _help("");
     string _unit("");
@@ -402,7 +801,7 @@ void PrintNodeHLP(std::ostream &out, Property &p, const int start_level=0, int l
     }
 }
 
-std::ostream &operator<<(std::ostream &out, Property& p)
+std::ostream &operator<<(std::ostream &out, const Property& p)
 {
     if (!out.good())
         return out;
@@ -455,4 +854,35 @@ std::ostream &operator<<(std::ostream &out, Property& p)
 };
 
 
+size_t Property::MemoryUsage() const
+{
+    size_t bytes = sizeof(*this) + tools::MemoryUsage(_name)
+        + tools::MemoryUsage(_value) + tools::MemoryUsage(_path);
+
+    // _map has one entry per child name
+    for(map<string,Property*>::const_iterator iter = _map.begin(); iter != _map.end(); ++iter)
+        bytes += MEMSTAT_MAP_NODE + sizeof(*iter) + tools::MemoryUsage(iter->first);
+
+    for(map<string,string>::const_iterator iter = _attributes.begin(); iter != _attributes.end(); ++iter)
+        bytes += MEMSTAT_MAP_NODE + sizeof(*iter) + tools::MemoryUsage(iter->first)
+            + tools::MemoryUsage(iter->second);
+
+    // child nodes are stored in the list, sizeof(Property) is counted by the child
+    for(list<Property>::const_iterator iter = _properties.begin(); iter != _properties.end(); ++iter)
+        bytes += MEMSTAT_LIST_NODE + iter->MemoryUsage();
+
+    if(_index) {
+        bytes += sizeof(PathIndex) + _index->_entries.capacity() * sizeof(PathIndex::entry_t)
+            + _index->_lookup.bucket_count() * sizeof(void *);
+        for(vector<PathIndex::entry_t>::const_iterator iter = _index->_entries.begin();
+                iter != _index->_entries.end(); ++iter)
+            bytes += tools::MemoryUsage(iter->_path);
+        for(boost::unordered_map<string, Property *>::const_iterator iter = _index->_lookup.begin();
+                iter != _index->_lookup.end(); ++iter)
+            bytes += MEMSTAT_MAP_NODE + sizeof(*iter) + tools::MemoryUsage(iter->first);
+    }
+
+    return bytes;
+}
+
 }}
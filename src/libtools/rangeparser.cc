@@ -21,11 +21,12 @@
 #include <iostream>
 #include <functional>
 #include <stdexcept>
+#include <algorithm>
 
 namespace votca { namespace tools {
 
 RangeParser::RangeParser()
-    : _has_begin(false) , _has_end(false)
+    : _count(0), _compiled(false), _has_begin(false) , _has_end(false)
 {
 }
 
@@ -41,6 +42,7 @@ void RangeParser::Parse(string str)
     
     for(bl=tok.begin(); bl!=tok.end();++bl)
         ParseBlock(*bl);
+    _compiled = false;
     
 //    list<block_t>::iterator iter;
 //    for(iter=_blocks.begin();iter!=_blocks.end();++iter) {
@@ -69,6 +71,9 @@ void RangeParser::ParseBlock(string str)
         block._end = ToNumber(toks[2]);
     }
         
+    if(block._stride == 0)
+        throw runtime_error("invalid range " + str + ": stride must not be 0");
+
     if(block._begin*block._stride > block._end*block._stride) {
         throw runtime_error(string("invalid range " + str + ": begin, end and stride do not form a closed interval"));
     }
@@ -94,4 +99,303 @@ RangeParser::iterator & RangeParser::iterator::operator++()
     return *this;
 }
 
+static const int BITS_PER_WORD = sizeof(unsigned long) * 8;
+
+static long long gcd(long long a, long long b)
+{
+    while(b) {
+        long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// set bits among the first n bits
+static size_t count_bits(const unsigned long *bits, size_t n)
+{
+    size_t c = 0;
+    for(size_t w = 0; w < n / BITS_PER_WORD; ++w)
+        c += __builtin_popcountl(bits[w]);
+    if(n % BITS_PER_WORD)
+        c += __builtin_popcountl(bits[n / BITS_PER_WORD] & ((1ul << (n % BITS_PER_WORD)) - 1));
+    return c;
+}
+
+static bool test_bit(const unsigned long *bits, long long n)
+{
+    return (bits[n / BITS_PER_WORD] >> (n % BITS_PER_WORD)) & 1;
+}
+
+bool RangeParser::run_t::Merge(const run_t &next)
+{
+    if(_bits >= 0 || next._bits >= 0 || _list >= 0 || next._list >= 0)
+        return false;
+    // a single number fits any stride
+    long long step = (long long)next._begin - _last;
+    bool single = _begin == _last;
+    bool next_single = next._begin == next._last;
+    long long stride;
+    if(single && next_single) stride = step;
+    else if(single) stride = next._stride;
+    else if(next_single) stride = _stride;
+    else if(_stride == next._stride) stride = _stride;
+    else return false;
+    if(step != stride)
+        return false;
+    _last = next._last;
+    _stride = stride;
+    return true;
+}
+
+void RangeParser::Compile() const
+{
+    if(_compiled) return;
+    // ascending runs, blocks with negative stride are reversed
+    vector<run_t> runs;
+    for(list<block_t>::const_iterator b = _blocks.begin(); b != _blocks.end(); ++b) {
+        long long n = ((long long)b->_end - b->_begin) / b->_stride;
+        if(n < 0) continue;
+        run_t r;
+        r._bits = -1;
+        r._list = -1;
+        r._stride = abs(b->_stride);
+        if(b->_stride > 0) {
+            r._begin = b->_begin;
+            r._last = b->_begin + n * b->_stride;
+        }
+        else {
+            r._begin = b->_begin + n * b->_stride;
+            r._last = b->_begin;
+        }
+        if(r._begin == r._last) r._stride = 1;
+        runs.push_back(r);
+    }
+    sort(runs.begin(), runs.end());
+
+    _runs.clear();
+    _bits.clear();
+    _numbers.clear();
+    size_t i = 0;
+    while(i < runs.size()) {
+        // cluster of overlapping runs
+        size_t j = i + 1;
+        int last = runs[i]._last;
+        for(; j < runs.size() && runs[j]._begin <= last; ++j)
+            last = max(last, runs[j]._last);
+
+        // the runs covering a number only change at their ends, in between
+        // their union is periodic
+        vector<long long> cuts;
+        for(size_t k = i; k < j; ++k) {
+            cuts.push_back(runs[k]._begin);
+            cuts.push_back((long long)runs[k]._last + 1);
+        }
+        sort(cuts.begin(), cuts.end());
+        cuts.erase(unique(cuts.begin(), cuts.end()), cuts.end());
+        for(size_t c = 0; c + 1 < cuts.size(); ++c)
+            CompileSegment(runs, i, j, cuts[c], cuts[c + 1] - 1);
+        i = j;
+    }
+
+    _count = 0;
+    for(vector<run_t>::iterator r = _runs.begin(); r != _runs.end(); ++r) {
+        if(r->_list >= 0)
+            r->_count = r->_stride;
+        else if(r->_bits >= 0)
+            r->_count = Rank(*r, (long long)r->_last - r->_begin + 1);
+        else
+            r->_count = ((long long)r->_last - r->_begin) / r->_stride + 1;
+        r->_offset = _count;
+        _count += r->_count;
+    }
+    _compiled = true;
+}
+
+void RangeParser::CompileSegment(const vector<run_t> &runs, size_t i, size_t j,
+        long long first, long long last) const
+{
+    // runs with numbers in the segment and the first of them
+    vector<const run_t *> active;
+    vector<long long> start;
+    bool interval = false, progression = true;
+    for(size_t k = i; k < j; ++k) {
+        const run_t &r = runs[k];
+        if(r._begin > first || r._last < last)
+            continue;
+        long long f = r._begin + (first - r._begin + r._stride - 1) / r._stride * r._stride;
+        if(f > last)
+            continue;
+        if(r._stride == 1)
+            interval = true;
+        if(!active.empty() && (r._stride != active[0]->_stride || f != start[0]))
+            progression = false;
+        active.push_back(&r);
+        start.push_back(f);
+    }
+    if(active.empty())
+        return;
+
+    run_t seg;
+    seg._bits = -1;
+    seg._list = -1;
+    if(interval || progression) {
+        seg._stride = interval ? 1 : active[0]->_stride;
+        seg._begin = interval ? first : start[0];
+        seg._last = seg._begin + (last - seg._begin) / seg._stride * seg._stride;
+        if(seg._begin == seg._last) seg._stride = 1;
+    }
+    else {
+        // mask of one common period, at most the whole segment
+        long long span = last - first + 1, period = 1;
+        for(size_t k = 0; k < active.size() && period < span; ++k)
+            period = period / gcd(period, active[k]->_stride) * active[k]->_stride;
+        period = min(period, span);
+        // numbers taken, counting overlaps twice
+        size_t taken = 0;
+        for(size_t k = 0; k < active.size(); ++k)
+            taken += (last - start[k]) / active[k]->_stride + 1;
+        seg._begin = first;
+        seg._last = last;
+        if(period / (long long)(sizeof(int) * 8) > (long long)taken) {
+            // strides with a long common period, the mask would be larger
+            // than a list of the numbers
+            seg._list = _numbers.size();
+            for(size_t k = 0; k < active.size(); ++k)
+                for(long long n = start[k]; n <= last; n += active[k]->_stride)
+                    _numbers.push_back(n);
+            sort(_numbers.begin() + seg._list, _numbers.end());
+            _numbers.erase(unique(_numbers.begin() + seg._list, _numbers.end()), _numbers.end());
+            seg._stride = _numbers.size() - seg._list;
+            _runs.push_back(seg);
+            return;
+        }
+        seg._stride = period;
+        seg._bits = _bits.size();
+        _bits.resize(_bits.size() + (period + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+        unsigned long *bits = &_bits[seg._bits];
+        for(size_t k = 0; k < active.size(); ++k)
+            for(long long n = start[k] - first; n < period; n += active[k]->_stride)
+                bits[n / BITS_PER_WORD] |= 1ul << (n % BITS_PER_WORD);
+    }
+    if(_runs.empty() || !_runs.back().Merge(seg))
+        _runs.push_back(seg);
+}
+
+size_t RangeParser::Rank(const run_t &r, long long n) const
+{
+    if(r._list >= 0) {
+        vector<int>::const_iterator list = _numbers.begin() + r._list;
+        return lower_bound(list, list + r._stride, r._begin + n) - list;
+    }
+    const unsigned long *bits = &_bits[r._bits];
+    return n / r._stride * count_bits(bits, r._stride) + count_bits(bits, n % r._stride);
+}
+
+long long RangeParser::Nth(const run_t &r, size_t i) const
+{
+    if(r._list >= 0)
+        return _numbers[r._list + i];
+    const unsigned long *bits = &_bits[r._bits];
+    size_t per_period = count_bits(bits, r._stride);
+    long long n = r._begin + (long long)(i / per_period) * r._stride;
+    i %= per_period;
+    for(size_t w = 0; ; ++w) {
+        unsigned long word = bits[w];
+        size_t c = __builtin_popcountl(word);
+        if(i < c) {
+            for(; i > 0; --i)
+                word &= word - 1;
+            return n + w * BITS_PER_WORD + __builtin_ctzl(word);
+        }
+        i -= c;
+    }
+}
+
+bool RangeParser::contains(int k) const
+{
+    Compile();
+    vector<run_t>::const_iterator r = upper_bound(_runs.begin(), _runs.end(), k, run_t::BeginLess);
+    if(r == _runs.begin()) return false;
+    --r;
+    if(k > r->_last) return false;
+    long long n = (long long)k - r->_begin;
+    if(r->_list >= 0)
+        return binary_search(_numbers.begin() + r->_list, _numbers.begin() + r->_list + r->_stride, k);
+    if(r->_bits >= 0)
+        return test_bit(&_bits[r->_bits], n % r->_stride);
+    return n % r->_stride == 0;
+}
+
+vector<RangeParser> RangeParser::Split(int n) const
+{
+    if(n < 1)
+        throw runtime_error("RangeParser::Split: number of parts must be positive");
+    Compile();
+    size_t nparts = min((size_t)n, _count);
+
+    vector<RangeParser> parts;
+    for(size_t p = 0; p < nparts; ++p) {
+        // numbers with index [lo, hi) of all numbers
+        size_t lo = _count * p / nparts;
+        size_t hi = _count * (p + 1) / nparts;
+        RangeParser part;
+
+        vector<run_t>::const_iterator r = upper_bound(_runs.begin(), _runs.end(), lo, run_t::OffsetLess);
+        for(--r; r != _runs.end() && r->_offset < hi; ++r) {
+            size_t a = max(lo, r->_offset) - r->_offset;
+            size_t b = min(hi, r->_offset + r->_count) - r->_offset;
+            if(r->_bits < 0 && r->_list < 0) {
+                part._blocks.push_back(block_t(r->_begin + a * r->_stride,
+                    r->_begin + (b - 1) * r->_stride, r->_stride));
+                continue;
+            }
+            if(r->_list >= 0) {
+                // numbers with equal distance become one block
+                const int *list = &_numbers[r->_list];
+                for(size_t i = a; i < b; ++i) {
+                    if(i > a) {
+                        block_t &block = part._blocks.back();
+                        if(block._begin == block._end)
+                            block._stride = list[i] - block._end;
+                        if(list[i] - block._end == block._stride) {
+                            block._end = list[i];
+                            continue;
+                        }
+                    }
+                    part._blocks.push_back(block_t(list[i], list[i], 1));
+                }
+                continue;
+            }
+            const unsigned long *bits = &_bits[r->_bits];
+            long long first = Nth(*r, a), last = Nth(*r, b - 1), period = r->_stride;
+            if(last - first < period) {
+                // within one period consecutive numbers become one block
+                bool open = false;
+                for(long long k = first; k <= last; ++k) {
+                    bool set = test_bit(bits, (k - r->_begin) % period);
+                    if(set && open)
+                        part._blocks.back()._end = k;
+                    else if(set)
+                        part._blocks.push_back(block_t(k, k, 1));
+                    open = set;
+                }
+                continue;
+            }
+            // one block for each number taken in the period
+            for(long long i = 0; i < period; ++i) {
+                if(!test_bit(bits, i))
+                    continue;
+                long long base = r->_begin + i;
+                long long from = first <= base ? base
+                    : base + (first - base + period - 1) / period * period;
+                long long to = base + (last - base) / period * period;
+                part._blocks.push_back(block_t(from, to, from == to ? 1 : period));
+            }
+        }
+        parts.push_back(part);
+    }
+    return parts;
+}
+
 }}
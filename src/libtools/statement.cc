@@ -16,6 +16,7 @@
  */
 
 #include <string>
+#include <vector>
 #include <votca/tools/statement.h>
 #include <stdexcept>
 
@@ -42,12 +43,44 @@ void Statement::Bind(int col, const double &value)
       throw std::runtime_error("sqlite_bind failed");
 }
 
+template<>
+void Statement::Bind(int col, const sqlite3_int64 &value)
+{
+	if(sqlite3_bind_int64(_stmt, col, value) != SQLITE_OK)
+      throw std::runtime_error("sqlite_bind failed");
+}
+
+template<>
+void Statement::Bind(int col, const vector<double> &value)
+{
+    BindBlob(col, value);
+}
+
+void Statement::BindBlob(int col, const void *data, int size, bool copy)
+{
+    int ret;
+    // a NULL pointer would bind NULL instead of an empty blob
+    if(size == 0)
+        ret = sqlite3_bind_zeroblob(_stmt, col, 0);
+    else
+        ret = sqlite3_bind_blob(_stmt, col, data, size,
+            copy ? SQLITE_TRANSIENT : SQLITE_STATIC);
+    if(ret != SQLITE_OK)
+      throw std::runtime_error("sqlite_bind failed");
+}
+
 template<>
 int Statement::Column<int>(int col)
 {
 	return sqlite3_column_int(_stmt, col);
 }
 
+template<>
+sqlite3_int64 Statement::Column<sqlite3_int64>(int col)
+{
+	return sqlite3_column_int64(_stmt, col);
+}
+
 template<>
 double Statement::Column<double>(int col)
 {
@@ -57,13 +90,33 @@ double Statement::Column<double>(int col)
 template<>
 string Statement::Column<string>(int col)
 {
-	return string((const char*)sqlite3_column_text(_stmt, col));
+    int size;
+    const char *text = ColumnText(col, &size);
+    return string(text, size);
+}
+
+template<>
+vector<double> Statement::Column< vector<double> >(int col)
+{
+    vector<double> v;
+    ColumnBlob<double>(col).CopyTo(v);
+    return v;
+}
+
+const char *Statement::ColumnText(int col, int *size)
+{
+    const char *text = (const char*)sqlite3_column_text(_stmt, col);
+    // sqlite3_column_bytes has to be called after sqlite3_column_text
+    if(size) *size = sqlite3_column_bytes(_stmt, col);
+    // NULL columns are returned as empty string
+    return text ? text : "";
 }
 
 template<>
 void Statement::Bind(int col, const string &value)
 {
-    if(sqlite3_bind_text(_stmt, col, value.c_str(), -1, NULL) != SQLITE_OK)
+    // the string might be a temporary, so sqlite has to make a copy
+    if(sqlite3_bind_text(_stmt, col, value.c_str(), value.size(), SQLITE_TRANSIENT) != SQLITE_OK)
       throw std::runtime_error("sqlite_bind failed");
 }
 
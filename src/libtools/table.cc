@@ -23,12 +23,48 @@
 #include <iostream>
 #include <boost/algorithm/string/replace.hpp>
 #include <votca/tools/lexical_cast.h>
+#include <votca/tools/memstat.h>
+#include <votca/tools/compressedstream.h>
+#include <votca/tools/convolution.h>
 
 namespace votca { namespace tools {
 
 using namespace boost;
 using namespace std;
 
+Table::~Table()
+{
+    Memory().Account(_accounted, 0);
+}
+
+Table &Table::operator=(const Table &tbl)
+{
+    if(this == &tbl) return *this;
+    _x = tbl._x;
+    _y = tbl._y;
+    _flags = tbl._flags;
+    _yerr = tbl._yerr;
+    _error_details = tbl._error_details;
+    _has_yerr = tbl._has_yerr;
+    _has_comment = tbl._has_comment;
+    _comment_line = tbl._comment_line;
+    Account();
+    return *this;
+}
+
+MemCounter &Table::Memory()
+{
+    // never destroyed, tables may outlive static objects
+    static MemCounter *counter = new MemCounter("Table");
+    return *counter;
+}
+
+void Table::Account()
+{
+    Memory().Account(_accounted, _x.size()*sizeof(double) + _y.size()*sizeof(double)
+        + _flags.size()*sizeof(char) + _yerr.size()*sizeof(double));
+}
+
 void Table::resize(int N, bool preserve)
 {
     _x.resize(N, preserve);
@@ -37,12 +73,14 @@ void Table::resize(int N, bool preserve)
     if (_has_yerr) {
         _yerr.resize(N, preserve);
     }
+    Account();
 }
 
 void Table::Load(string filename)
 {
-    ifstream in;
-    in.open(filename.c_str());
+    // compressed files are detected by their magic bytes
+    CompressedIFStream in;
+    in.open(filename);
     if(!in)
         throw runtime_error(string("error, cannot open file ") + filename);
 
@@ -54,8 +92,9 @@ void Table::Load(string filename)
 
 void Table::Save(string filename) const
 {
-    ofstream out;
-    out.open(filename.c_str());
+    // compression is chosen by the extension (.gz, .bz2, .zst)
+    CompressedOFStream out;
+    out.open(filename);
     if(!out)
         throw runtime_error(string("error, cannot open file ") + filename);
 
@@ -76,6 +115,7 @@ void Table::clear(void)
     _y.clear();
     _flags.clear();
     _yerr.clear();
+    Account();
 }
 
 // TODO: this functon is weired, reading occours twice, cleanup!!
@@ -86,6 +126,9 @@ istream &operator>>(istream &in, Table& t)
     bool bHasN=false;
     string line;
     int line_number=0;
+    // Table::push_back reallocates on every call, collect the data first
+    vector<double> x, y;
+    vector<char> flags;
    t.clear();
     
     // read till the first data line
@@ -112,14 +155,18 @@ istream &operator>>(istream &in, Table& t)
         }
         // it's the first data line with 2 or 3 entries
         else if(tokens.size() == 2) {
-            t.push_back(lexical_cast<double>(tokens[0], conversion_error), lexical_cast<double>(tokens[1], conversion_error), 'i');
+            x.push_back(lexical_cast<double>(tokens[0], conversion_error));
+            y.push_back(lexical_cast<double>(tokens[1], conversion_error));
+            flags.push_back('i');
         }
         else if(tokens.size() > 2) {
            char flag='i';
            string sflag = tokens.back();
             if(sflag == "i" || sflag == "o" || sflag == "u")
                 flag = sflag.c_str()[0];
-            t.push_back(lexical_cast<double>(tokens[0], conversion_error), lexical_cast<double>(tokens[1], conversion_error), flag);
+            x.push_back(lexical_cast<double>(tokens[0], conversion_error));
+            y.push_back(lexical_cast<double>(tokens[1], conversion_error));
+            flags.push_back(flag);
         }
         else throw runtime_error("error, wrong table format");                                
     }
@@ -143,13 +190,17 @@ istream &operator>>(istream &in, Table& t)
                     
         // it's a data line
         if(tokens.size() == 2) {            
-            t.push_back(lexical_cast<double>(tokens[0], conversion_error), lexical_cast<double>(tokens[1], conversion_error), 'i');
+            x.push_back(lexical_cast<double>(tokens[0], conversion_error));
+            y.push_back(lexical_cast<double>(tokens[1], conversion_error));
+            flags.push_back('i');
         }
         else if(tokens.size() > 2) {
             char flag='i';
             if(tokens[2] == "i" || tokens[2] == "o" || tokens[2] == "u")
                 flag = tokens[2].c_str()[0];
-            t.push_back(lexical_cast<double>(tokens[0], conversion_error), lexical_cast<double>(tokens[1], conversion_error), flag);
+            x.push_back(lexical_cast<double>(tokens[0], conversion_error));
+            y.push_back(lexical_cast<double>(tokens[1], conversion_error));
+            flags.push_back(flag);
         }
         // otherwise error
         else throw runtime_error("error, wrong table format");                                
@@ -159,6 +210,11 @@ istream &operator>>(istream &in, Table& t)
             if(--N == 0) break;
     }
 
+    t.resize(x.size());
+    std::copy(x.begin(), x.end(), t._x.begin());
+    std::copy(y.begin(), y.end(), t._y.begin());
+    std::copy(flags.begin(), flags.end(), t._flags.begin());
+
     return in;
 }
 
@@ -177,5 +233,32 @@ void Table::Smooth(int Nsmooth)
         for(int i=1; i<size()-1; ++i)
             _y[i] =0.25*(_y[i-1] + 2*_y[i] +  _y[i+1]);
 }
+
+void Table::SmoothBinomial(int passes)
+{
+    vector<double> kernel;
+    Convolution::Binomial(passes, kernel);
+    Convolution::Apply(_y.data().begin(), _y.data().begin(), size(), kernel, Convolution::Mirror);
+}
+
+void Table::SmoothGaussian(double sigma)
+{
+    vector<double> kernel;
+    Convolution::Gaussian(sigma, kernel);
+    Convolution::Apply(_y.data().begin(), _y.data().begin(), size(), kernel, Convolution::Mirror);
+}
+
+void Table::SmoothSavitzkyGolay(int m, int order)
+{
+    Convolution::ApplySavitzkyGolay(_y.data().begin(), _y.data().begin(), size(), m, order);
+}
     
+size_t Table::MemoryUsage() const
+{
+    return sizeof(*this)
+        + _x.size()*sizeof(double) + _y.size()*sizeof(double)
+        + _flags.size()*sizeof(char) + _yerr.size()*sizeof(double)
+        + tools::MemoryUsage(_error_details) + tools::MemoryUsage(_comment_line);
+}
+
 }}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/tablecache.h>
+#include <votca/tools/mutex.h>
+#include <map>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+namespace {
+
+struct cache_entry_t {
+    time_t _mtime;
+    off_t _size;
+    boost::shared_ptr<const Table> _table;
+};
+
+Mutex &cache_lock()
+{
+    static Mutex lock;
+    return lock;
+}
+
+map<string, cache_entry_t> &cache()
+{
+    static map<string, cache_entry_t> entries;
+    return entries;
+}
+
+size_t hits = 0;
+size_t misses = 0;
+
+}
+
+boost::shared_ptr<const Table> TableCache::Load(const string &filename)
+{
+    struct stat st;
+    if(stat(filename.c_str(), &st) != 0)
+        throw runtime_error("error, cannot open file " + filename);
+
+    cache_lock().Lock();
+    map<string, cache_entry_t>::iterator iter = cache().find(filename);
+    if(iter != cache().end() && iter->second._mtime == st.st_mtime
+            && iter->second._size == st.st_size) {
+        boost::shared_ptr<const Table> t = iter->second._table;
+        ++hits;
+        cache_lock().Unlock();
+        return t;
+    }
+    ++misses;
+    cache_lock().Unlock();
+
+    // read outside of the lock, two threads might read the same file
+    // at the same time, the last one wins
+    boost::shared_ptr<Table> t(new Table());
+    t->Load(filename);
+
+    cache_entry_t entry;
+    entry._mtime = st.st_mtime;
+    entry._size = st.st_size;
+    entry._table = t;
+    cache_lock().Lock();
+    cache()[filename] = entry;
+    cache_lock().Unlock();
+    return t;
+}
+
+void TableCache::Invalidate(const string &filename)
+{
+    cache_lock().Lock();
+    cache().erase(filename);
+    cache_lock().Unlock();
+}
+
+void TableCache::Clear()
+{
+    cache_lock().Lock();
+    cache().clear();
+    cache_lock().Unlock();
+}
+
+size_t TableCache::getHits()
+{
+    return hits;
+}
+
+size_t TableCache::getMisses()
+{
+    return misses;
+}
+
+}}
@@ -0,0 +1,468 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/tablemath.h>
+#include <votca/tools/cubicspline.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+const char TableMath::INVALID;
+
+void TableMath::CheckSize(const Table &a, const Table &b)
+{
+    if(a.size() != b.size())
+        throw runtime_error("TableMath: tables differ in size");
+}
+
+void TableMath::MergeFlags(char *dst, const char *src, int n)
+{
+    for(int i = 0; i < n; ++i)
+        dst[i] = IsValid(src[i]) ? dst[i] : INVALID;
+}
+
+void TableMath::Scale(Table &t, double a, double b)
+{
+    double *y = t.y().data().begin();
+    int n = t.size();
+    for(int i = 0; i < n; ++i)
+        y[i] = a * y[i] + b;
+}
+
+void TableMath::Axpy(Table &t, double a, const Table &other)
+{
+    CheckSize(t, other);
+    double *y = t.y().data().begin();
+    const double *o = other.y().data().begin();
+    int n = t.size();
+    for(int i = 0; i < n; ++i)
+        y[i] += a * o[i];
+    MergeFlags(t.flags().data().begin(), other.flags().data().begin(), n);
+}
+
+void TableMath::Multiply(Table &t, const Table &other)
+{
+    CheckSize(t, other);
+    double *y = t.y().data().begin();
+    const double *o = other.y().data().begin();
+    int n = t.size();
+    for(int i = 0; i < n; ++i)
+        y[i] *= o[i];
+    MergeFlags(t.flags().data().begin(), other.flags().data().begin(), n);
+}
+
+void TableMath::Divide(Table &t, const Table &other)
+{
+    CheckSize(t, other);
+    double *y = t.y().data().begin();
+    char *f = t.flags().data().begin();
+    const double *o = other.y().data().begin();
+    int n = t.size();
+    for(int i = 0; i < n; ++i) {
+        bool zero = (o[i] == 0);
+        y[i] = zero ? 0 : y[i] / (zero ? 1 : o[i]);
+    }
+    MergeFlags(f, other.flags().data().begin(), n);
+    for(int i = 0; i < n; ++i)
+        f[i] = o[i] == 0 ? INVALID : f[i];
+}
+
+// y = a*ln(y), invalid where y <= 0
+static void log_scaled(Table &t, double a)
+{
+    double *y = t.y().data().begin();
+    char *f = t.flags().data().begin();
+    int n = t.size();
+    for(int i = 0; i < n; ++i) {
+        bool bad = !(y[i] > 0);
+        f[i] = bad ? TableMath::INVALID : f[i];
+        y[i] = bad ? 0 : a * log(y[i]);
+    }
+}
+
+void TableMath::Log(Table &t)
+{
+    log_scaled(t, 1.0);
+}
+
+void TableMath::BoltzmannInvert(Table &t, double kT)
+{
+    log_scaled(t, -kT);
+}
+
+void TableMath::Exp(Table &t)
+{
+    double *y = t.y().data().begin();
+    int n = t.size();
+    for(int i = 0; i < n; ++i)
+        y[i] = exp(y[i]);
+}
+
+void TableMath::Boltzmann(Table &t, double kT)
+{
+    double *y = t.y().data().begin();
+    double beta = -1.0 / kT;
+    int n = t.size();
+    for(int i = 0; i < n; ++i)
+        y[i] = exp(beta * y[i]);
+}
+
+void TableMath::FillInvalid(Table &t, double value)
+{
+    double *y = t.y().data().begin();
+    const char *f = t.flags().data().begin();
+    int n = t.size();
+    for(int i = 0; i < n; ++i)
+        y[i] = IsValid(f[i]) ? y[i] : value;
+}
+
+int TableMath::CountValid(const Table &t)
+{
+    const char *f = t.flags().data().begin();
+    int n = t.size(), count = 0;
+    for(int i = 0; i < n; ++i)
+        count += IsValid(f[i]);
+    return count;
+}
+
+double TableMath::Sum(const Table &t)
+{
+    const double *y = t.y().data().begin();
+    const char *f = t.flags().data().begin();
+    int n = t.size();
+    double sum = 0;
+    for(int i = 0; i < n; ++i)
+        sum += IsValid(f[i]) ? y[i] : 0;
+    return sum;
+}
+
+double TableMath::Mean(const Table &t)
+{
+    int count = CountValid(t);
+    if(count == 0)
+        throw runtime_error("TableMath::Mean: table has no valid entries");
+    return Sum(t) / count;
+}
+
+double TableMath::Min(const Table &t)
+{
+    if(CountValid(t) == 0)
+        throw runtime_error("TableMath::Min: table has no valid entries");
+    const double *y = t.y().data().begin();
+    const char *f = t.flags().data().begin();
+    int n = t.size();
+    double m = numeric_limits<double>::infinity();
+    for(int i = 0; i < n; ++i) {
+        double v = IsValid(f[i]) ? y[i] : m;
+        m = v < m ? v : m;
+    }
+    return m;
+}
+
+double TableMath::Max(const Table &t)
+{
+    if(CountValid(t) == 0)
+        throw runtime_error("TableMath::Max: table has no valid entries");
+    const double *y = t.y().data().begin();
+    const char *f = t.flags().data().begin();
+    int n = t.size();
+    double m = -numeric_limits<double>::infinity();
+    for(int i = 0; i < n; ++i) {
+        double v = IsValid(f[i]) ? y[i] : m;
+        m = v > m ? v : m;
+    }
+    return m;
+}
+
+double TableMath::Dot(const Table &a, const Table &b)
+{
+    CheckSize(a, b);
+    const double *ya = a.y().data().begin(), *yb = b.y().data().begin();
+    const char *fa = a.flags().data().begin(), *fb = b.flags().data().begin();
+    int n = a.size();
+    double sum = 0;
+    for(int i = 0; i < n; ++i)
+        sum += (IsValid(fa[i]) && IsValid(fb[i])) ? ya[i] * yb[i] : 0;
+    return sum;
+}
+
+// integral of the parabola through (xa,fa), (xb,fb), (xc,fc) from lo to hi
+static double parabola_integral(double xa, double xb, double xc,
+    double fa, double fb, double fc, double lo, double hi)
+{
+    double H = hi - lo, H2 = H * H / 2, H3 = H * H * H / 3;
+    xa -= lo; xb -= lo; xc -= lo;
+    // int_0^H (u-p)(u-q) du
+    double ia = H3 - (xb + xc) * H2 + xb * xc * H;
+    double ib = H3 - (xa + xc) * H2 + xa * xc * H;
+    double ic = H3 - (xa + xb) * H2 + xa * xb * H;
+    return fa * ia / ((xa - xb) * (xa - xc))
+        + fb * ib / ((xb - xa) * (xb - xc))
+        + fc * ic / ((xc - xa) * (xc - xb));
+}
+
+// second derivatives of the natural spline, Thomas algorithm
+static void natural_spline(const double *x, const double *y, int n, double *d)
+{
+    vector<double> pivot(n, 1);
+    d[0] = d[n - 1] = 0;
+    for(int i = 1; i < n - 1; ++i) {
+        double hl = x[i] - x[i - 1], hr = x[i + 1] - x[i];
+        double l = i > 1 ? hl / pivot[i - 1] : 0;
+        pivot[i] = 2 * (hl + hr) - l * hl;
+        d[i] = 6 * ((y[i + 1] - y[i]) / hr - (y[i] - y[i - 1]) / hl) - l * d[i - 1];
+    }
+    for(int i = n - 2; i > 0; --i)
+        d[i] = (d[i] - (x[i + 1] - x[i]) * d[i + 1]) / pivot[i];
+}
+
+// exact integrals of a cubic spline, sum[i] = int_x[0]^x[i]
+static void spline_integral(const double *x, const double *y, const double *d,
+    int n, double *sum)
+{
+    double s = 0;
+    sum[0] = 0;
+    for(int i = 0; i < n - 1; ++i) {
+        double h = x[i + 1] - x[i];
+        s += 0.5 * h * (y[i] + y[i + 1]) - h * h * h / 24 * (d[i] + d[i + 1]);
+        sum[i + 1] = s;
+    }
+}
+
+// cumulative integral of n points into sum
+static void cumulative_integral(const double *x, const double *y, int n,
+    double *sum, TableMath::Integration method)
+{
+    if(n == 0) return;
+    sum[0] = 0;
+    if(n < 3 && method != TableMath::Trapezoid)
+        method = TableMath::Trapezoid;
+
+    if(method == TableMath::Spline) {
+        vector<double> d(n);
+        natural_spline(x, y, n, &d[0]);
+        spline_integral(x, y, &d[0], n, sum);
+        return;
+    }
+
+    double s = 0;
+    for(int i = 0; i < n - 1; ++i) {
+        if(method == TableMath::Trapezoid)
+            s += 0.5 * (x[i + 1] - x[i]) * (y[i] + y[i + 1]);
+        else {
+            // average the parabolas to the left and right where both
+            // exist, which cancels the leading error on uniform grids
+            double part = 0;
+            int count = 0;
+            if(i > 0) {
+                part += parabola_integral(x[i - 1], x[i], x[i + 1],
+                    y[i - 1], y[i], y[i + 1], x[i], x[i + 1]);
+                ++count;
+            }
+            if(i < n - 2) {
+                part += parabola_integral(x[i], x[i + 1], x[i + 2],
+                    y[i], y[i + 1], y[i + 2], x[i], x[i + 1]);
+                ++count;
+            }
+            s += part / count;
+        }
+        sum[i + 1] = s;
+    }
+}
+
+void TableMath::Integrate(Table &t, Integration method)
+{
+    int n = t.size();
+    double *x = t.x().data().begin();
+    double *y = t.y().data().begin();
+    char *f = t.flags().data().begin();
+    vector<double> sum(n);
+
+    int valid = CountValid(t);
+    if(valid == n) {
+        cumulative_integral(x, y, n, &sum[0], method);
+        copy(sum.begin(), sum.end(), y);
+        return;
+    }
+
+    // integrate the valid entries only
+    vector<double> vx, vy;
+    vx.reserve(valid);
+    vy.reserve(valid);
+    for(int i = 0; i < n; ++i)
+        if(IsValid(f[i])) {
+            vx.push_back(x[i]);
+            vy.push_back(y[i]);
+        }
+    if(valid > 0)
+        cumulative_integral(&vx[0], &vy[0], valid, &sum[0], method);
+
+    // scatter back, invalid entries in between are interpolated
+    int k = 0;
+    for(int i = 0; i < n; ++i) {
+        if(IsValid(f[i])) {
+            y[i] = sum[k++];
+            continue;
+        }
+        f[i] = INVALID;
+        if(k == 0)
+            y[i] = 0;
+        else if(k == valid)
+            y[i] = sum[valid - 1];
+        else
+            y[i] = sum[k - 1] + (sum[k] - sum[k - 1])
+                * (x[i] - vx[k - 1]) / (vx[k] - vx[k - 1]);
+    }
+}
+
+void TableMath::Integrate(CubicSpline &spline, Table &out)
+{
+    int n = spline.getX().size();
+    out.resize(n);
+    out.x() = spline.getX();
+    for(int i = 0; i < n; ++i)
+        out.flags()[i] = 'i';
+    if(n == 0) return;
+    spline_integral(spline.getX().data().begin(), spline.getSplineF().data().begin(),
+        spline.getSplineF2().data().begin(), n, out.y().data().begin());
+}
+
+// Fornberg's weights of the derivatives 0..m at z for the points x[0..s-1],
+// c[j*(m+1) + k] is the weight of point j for derivative k
+static void fornberg(const double *x, int s, double z, int m, double *c)
+{
+    for(int i = 0; i < s * (m + 1); ++i)
+        c[i] = 0;
+    double c1 = 1, c4 = x[0] - z;
+    c[0] = 1;
+    for(int i = 1; i < s; ++i) {
+        int mn = i < m ? i : m;
+        double c2 = 1, c5 = c4;
+        c4 = x[i] - z;
+        for(int j = 0; j < i; ++j) {
+            double c3 = x[i] - x[j];
+            c2 *= c3;
+            if(j == i - 1) {
+                for(int k = mn; k > 0; --k)
+                    c[i * (m + 1) + k] = c1 * (k * c[(i - 1) * (m + 1) + k - 1]
+                        - c5 * c[(i - 1) * (m + 1) + k]) / c2;
+                c[i * (m + 1)] = -c1 * c5 * c[(i - 1) * (m + 1)] / c2;
+            }
+            for(int k = mn; k > 0; --k)
+                c[j * (m + 1) + k] = (c4 * c[j * (m + 1) + k]
+                    - k * c[j * (m + 1) + k - 1]) / c3;
+            c[j * (m + 1)] = c4 * c[j * (m + 1)] / c3;
+        }
+        c1 = c2;
+    }
+}
+
+void TableMath::Derivative(Table &t, int deriv, int accuracy)
+{
+    if(deriv < 1 || accuracy < 1)
+        throw runtime_error("TableMath::Derivative: order and accuracy have to be positive");
+    int n = t.size();
+    const double *x = t.x().data().begin();
+    double *y = t.y().data().begin();
+    char *f = t.flags().data().begin();
+
+    // the weights of a uniform grid only depend on the stencil position
+    bool uniform = n > 1;
+    double h = n > 1 ? (x[n - 1] - x[0]) / (n - 1) : 0;
+    for(int i = 1; i < n && uniform; ++i)
+        uniform = fabs(x[i] - x[i - 1] - h) <= 1e-10 * fabs(h);
+
+    // on a uniform grid a centered stencil of odd size s has the even
+    // order s - deriv rounded up, otherwise (and at the ends) deriv + accuracy
+    // points are needed
+    int s = deriv + accuracy;
+    if(uniform) {
+        s = deriv % 2 ? deriv + 2 : deriv + 1;
+        while((s - deriv + 1) / 2 * 2 < accuracy)
+            s += 2;
+    }
+    int half = s / 2;
+    int se = max(s, deriv + accuracy);
+    if(n < se)
+        throw runtime_error("TableMath::Derivative: table is too short for the stencil");
+
+    vector<double> c(se * (deriv + 1)), w(se);
+    // rows 0..half-1 are the left end, row half the interior, the right
+    // end follows by symmetry
+    vector<double> uw;
+    if(uniform) {
+        vector<double> ux(se);
+        for(int j = 0; j < se; ++j)
+            ux[j] = j * h;
+        uw.resize((half + 1) * se);
+        for(int p = 0; p <= half; ++p) {
+            int size = p < half ? se : s;
+            fornberg(&ux[0], size, p * h, deriv, &c[0]);
+            for(int j = 0; j < size; ++j)
+                uw[p * se + j] = c[j * (deriv + 1) + deriv];
+        }
+    }
+
+    vector<double> dy(n);
+    vector<char> df(n);
+    double sign = deriv % 2 ? -1 : 1;
+    for(int i = 0; i < n; ++i) {
+        int first = i - half, size = s;
+        if(i < half) {
+            first = 0;
+            size = se;
+        }
+        else if(i >= n - half) {
+            first = n - se;
+            size = se;
+        }
+        const double *weights;
+        if(uniform) {
+            if(i >= n - half) {
+                // mirror of the left end
+                int p = n - 1 - i;
+                for(int j = 0; j < se; ++j)
+                    w[j] = sign * uw[p * se + se - 1 - j];
+                weights = &w[0];
+            }
+            else
+                weights = &uw[(i < half ? i : half) * se];
+        }
+        else {
+            fornberg(x + first, size, x[i], deriv, &c[0]);
+            for(int j = 0; j < size; ++j)
+                w[j] = c[j * (deriv + 1) + deriv];
+            weights = &w[0];
+        }
+        double sum = 0;
+        bool valid = true;
+        for(int j = 0; j < size; ++j) {
+            sum += weights[j] * y[first + j];
+            valid = valid && IsValid(f[first + j]);
+        }
+        dy[i] = sum;
+        df[i] = valid ? f[i] : INVALID;
+    }
+    copy(dy.begin(), dy.end(), y);
+    copy(df.begin(), df.end(), f);
+}
+
+}}
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/tableresample.h>
+#include <votca/tools/tablemath.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+static bool same_grid(const vector<double> &a, const ub::vector<double> &b)
+{
+    return a.size() == b.size() && equal(a.begin(), a.end(), b.begin());
+}
+
+void TableResample::setMethod(Method method)
+{
+    if(method != _method)
+        _from.clear();
+    _method = method;
+}
+
+void TableResample::Prepare(const ub::vector<double> &from, const ub::vector<double> &to)
+{
+    int n = from.size(), m = to.size();
+    if(n < 2)
+        throw runtime_error("TableResample: source table needs at least 2 points");
+    for(int i = 1; i < n; ++i)
+        if(!(from[i] > from[i - 1]))
+            throw runtime_error("TableResample: source grid is not increasing");
+    for(int j = 1; j < m; ++j)
+        if(to[j] < to[j - 1])
+            throw runtime_error("TableResample: target grid is not increasing");
+
+    _from.assign(from.begin(), from.end());
+    _to.assign(to.begin(), to.end());
+    _interval.resize(m);
+    _weights.resize(4 * m);
+    _outside.resize(m);
+
+    // both grids are sorted, so the interval only moves forward
+    int k = 0;
+    for(int j = 0; j < m; ++j) {
+        double x = to[j];
+        while(k < n - 2 && x >= from[k + 1])
+            ++k;
+        double h = from[k + 1] - from[k];
+        double t = (x - from[k]) / h, u = 1 - t;
+        double *w = &_weights[4 * j];
+        _interval[j] = k;
+        _outside[j] = x < from[0] || x > from[n - 1];
+        w[0] = u;
+        w[1] = t;
+        switch(_method) {
+            case Linear:
+                w[2] = w[3] = 0;
+                break;
+            case Cubic:
+                w[2] = h * h / 6 * (u * u * u - u);
+                w[3] = h * h / 6 * (t * t * t - t);
+                break;
+            case Akima:
+                // cubic hermite basis
+                w[0] = u * u * (1 + 2 * t);
+                w[1] = t * t * (1 + 2 * u);
+                w[2] = h * t * u * u;
+                w[3] = -h * t * t * u;
+                break;
+        }
+    }
+
+    // LU factors of the natural spline system, only the right hand side
+    // depends on the table
+    if(_method == Cubic) {
+        _lower.assign(n, 0);
+        _pivot.assign(n, 1);
+        for(int i = 1; i < n - 1; ++i) {
+            double hl = from[i] - from[i - 1], hr = from[i + 1] - from[i];
+            _lower[i] = i > 1 ? hl / _pivot[i - 1] : 0;
+            _pivot[i] = 2 * (hl + hr) - _lower[i] * hl;
+        }
+    }
+}
+
+void TableResample::SecondDerivatives(const double *y, int a, int b)
+{
+    const double *x = &_from[0];
+    double *d = &_d[0];
+    // the factorization only looks back, so the cached one holds for runs
+    // starting at the first point, other runs restart it
+    const double *lower = &_lower[0], *pivot = &_pivot[0];
+    vector<double> run_lower, run_pivot;
+    if(a > 0) {
+        run_lower.assign(_from.size(), 0);
+        run_pivot.assign(_from.size(), 1);
+        for(int i = a + 1; i < b; ++i) {
+            double hl = x[i] - x[i - 1], hr = x[i + 1] - x[i];
+            run_lower[i] = i > a + 1 ? hl / run_pivot[i - 1] : 0;
+            run_pivot[i] = 2 * (hl + hr) - run_lower[i] * hl;
+        }
+        lower = &run_lower[0];
+        pivot = &run_pivot[0];
+    }
+    // forward sweep
+    d[a] = d[b] = 0;
+    for(int i = a + 1; i < b; ++i) {
+        double hl = x[i] - x[i - 1], hr = x[i + 1] - x[i];
+        d[i] = 6 * ((y[i + 1] - y[i]) / hr - (y[i] - y[i - 1]) / hl)
+            - lower[i] * d[i - 1];
+    }
+    // back substitution, the ends stay 0
+    for(int i = b - 1; i > a; --i)
+        d[i] = (d[i] - (x[i + 1] - x[i]) * d[i + 1]) / pivot[i];
+}
+
+void TableResample::AkimaSlopes(const double *y, int a, int b)
+{
+    int n = b - a + 1;
+    const double *x = &_from[a];
+    y += a;
+    // segment slopes, extended by two on each side
+    vector<double> m(n + 3);
+    for(int i = 0; i < n - 1; ++i)
+        m[i + 2] = (y[i + 1] - y[i]) / (x[i + 1] - x[i]);
+    double left = n > 2 ? m[3] : m[2], right = n > 2 ? m[n - 1] : m[n];
+    m[1] = 2 * m[2] - left;
+    m[0] = 2 * m[1] - m[2];
+    m[n + 1] = 2 * m[n] - right;
+    m[n + 2] = 2 * m[n + 1] - m[n];
+
+    double *d = &_d[a];
+    for(int i = 0; i < n; ++i) {
+        double w1 = fabs(m[i + 3] - m[i + 2]), w2 = fabs(m[i + 1] - m[i]);
+        d[i] = w1 + w2 > 0 ? (w1 * m[i + 1] + w2 * m[i + 2]) / (w1 + w2)
+            : 0.5 * (m[i + 1] + m[i + 2]);
+    }
+}
+
+void TableResample::Resample(const Table &in, Table &out)
+{
+    if(!same_grid(_from, in.x()) || !same_grid(_to, out.x()))
+        Prepare(in.x(), out.x());
+
+    const double *y = in.y().data().begin();
+    const char *f = in.flags().data().begin();
+    int n = _from.size();
+    _d.assign(n, 0);
+    // splines are built over runs of valid entries, so invalid values
+    // never reach other intervals through the spline system or the
+    // akima stencil
+    if(_method != Linear) {
+        for(int a = 0; a < n; ) {
+            if(!TableMath::IsValid(f[a])) {
+                ++a;
+                continue;
+            }
+            int b = a;
+            while(b + 1 < n && TableMath::IsValid(f[b + 1]))
+                ++b;
+            if(b > a) {
+                if(_method == Cubic)
+                    SecondDerivatives(y, a, b);
+                else
+                    AkimaSlopes(y, a, b);
+            }
+            a = b + 1;
+        }
+    }
+
+    int m = _to.size();
+    out.resize(m);
+    double *yo = out.y().data().begin();
+    char *fo = out.flags().data().begin();
+    const double *d = &_d[0];
+    for(int j = 0; j < m; ++j) {
+        int k = _interval[j];
+        const double *w = &_weights[4 * j];
+        yo[j] = w[0] * y[k] + w[1] * y[k + 1] + w[2] * d[k] + w[3] * d[k + 1];
+        if(!TableMath::IsValid(f[k]) || !TableMath::IsValid(f[k + 1]))
+            fo[j] = TableMath::INVALID;
+        else
+            fo[j] = _outside[j] ? 'o' : 'i';
+    }
+}
+
+void TableResample::Resample(const Table &in, Table &out, double min, double max, double step)
+{
+    out.GenerateGridSpacing(min, max, step);
+    Resample(in, out);
+}
+
+void TableResample::Resample(const std::vector<Table *> &in, const ub::vector<double> &grid,
+        const std::vector<Table *> &out)
+{
+    if(in.size() != out.size())
+        throw runtime_error("TableResample: number of source and result tables differ");
+    for(size_t i = 0; i < in.size(); ++i) {
+        out[i]->resize(grid.size());
+        out[i]->x() = grid;
+        Resample(*in[i], *out[i]);
+    }
+}
+
+}}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <votca/tools/threadpool.h>
+#include <votca/tools/thread.h>
+#include <votca/tools/profiler.h>
+#include <stdexcept>
+#include <errno.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace votca { namespace tools {
+
+using namespace std;
+
+class PoolWorker : public Thread
+{
+public:
+    PoolWorker(ThreadPool *pool) : _pool(pool), _jobs(0), _busy(0) {}
+
+    void Run() {
+        ThreadPool::entry_t entry;
+        while(_pool->NextJob(entry)) {
+            string error;
+            double start = Profiler::Now();
+            try {
+                ScopedTimer timer("ThreadPool::Job");
+                entry._job->Run();
+            } catch(std::exception &err) {
+                error = err.what();
+                if(error.empty()) error = "unknown error";
+            } catch(...) {
+                error = "unknown error";
+            }
+            _busy += Profiler::Now() - start;
+            ++_jobs;
+            _pool->JobDone(entry, error);
+        }
+    }
+
+    ThreadPool *_pool;
+    size_t _jobs;
+    double _busy;
+};
+
+ThreadPool::ThreadPool(int nthreads)
+    : _active(0), _shutdown(false), _interrupt(NULL)
+{
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_job_available, NULL);
+    pthread_cond_init(&_done, NULL);
+    _start = Profiler::Now();
+
+    if(nthreads <= 0)
+        nthreads = Processors();
+
+    // workers inherit the signal mask, keep SIGINT for the main thread
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    for(int i=0; i<nthreads; ++i) {
+        _workers.push_back(new PoolWorker(this));
+        _workers.back()->Start();
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+ThreadPool::~ThreadPool()
+{
+    pthread_mutex_lock(&_mutex);
+    _shutdown = true;
+    DiscardPending();
+    pthread_cond_broadcast(&_job_available);
+    pthread_mutex_unlock(&_mutex);
+
+    for(size_t i=0; i<_workers.size(); ++i) {
+        _workers[i]->WaitDone();
+        delete _workers[i];
+    }
+
+    pthread_cond_destroy(&_done);
+    pthread_cond_destroy(&_job_available);
+    pthread_mutex_destroy(&_mutex);
+}
+
+int ThreadPool::Processors()
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? n : 1;
+}
+
+void ThreadPool::Submit(Job *job, bool owned)
+{
+    entry_t entry;
+    entry._job = job;
+    entry._owned = owned;
+
+    pthread_mutex_lock(&_mutex);
+    if(Interrupted()) {
+        pthread_mutex_unlock(&_mutex);
+        if(owned) delete job;
+        return;
+    }
+    _queue.push_back(entry);
+    pthread_cond_signal(&_job_available);
+    pthread_mutex_unlock(&_mutex);
+}
+
+bool ThreadPool::NextJob(entry_t &entry)
+{
+    pthread_mutex_lock(&_mutex);
+    while(true) {
+        if(Interrupted())
+            DiscardPending();
+        if(_shutdown) {
+            pthread_mutex_unlock(&_mutex);
+            return false;
+        }
+        if(!_queue.empty()) break;
+        pthread_cond_wait(&_job_available, &_mutex);
+    }
+    entry = _queue.front();
+    _queue.pop_front();
+    ++_active;
+    pthread_mutex_unlock(&_mutex);
+    return true;
+}
+
+void ThreadPool::JobDone(const entry_t &entry, const string &error)
+{
+    if(entry._owned)
+        delete entry._job;
+
+    pthread_mutex_lock(&_mutex);
+    --_active;
+    if(!error.empty() && _error.empty())
+        _error = error;
+    pthread_cond_broadcast(&_done);
+    pthread_mutex_unlock(&_mutex);
+}
+
+void ThreadPool::DiscardPending()
+{
+    for(size_t i=0; i<_queue.size(); ++i)
+        if(_queue[i]._owned) delete _queue[i]._job;
+    _queue.clear();
+}
+
+void ThreadPool::Cancel()
+{
+    pthread_mutex_lock(&_mutex);
+    DiscardPending();
+    pthread_mutex_unlock(&_mutex);
+}
+
+bool ThreadPool::Wait()
+{
+    pthread_mutex_lock(&_mutex);
+    while(!_queue.empty() || _active > 0) {
+        if(Interrupted())
+            DiscardPending();
+        // poll, the interrupt flag might be set by a signal handler
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        struct timespec timeout;
+        timeout.tv_sec = now.tv_sec;
+        timeout.tv_nsec = now.tv_usec*1000 + 100000000;
+        if(timeout.tv_nsec >= 1000000000) {
+            timeout.tv_sec++;
+            timeout.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&_done, &_mutex, &timeout);
+    }
+    string error = _error;
+    _error = "";
+    pthread_mutex_unlock(&_mutex);
+
+    if(!error.empty())
+        throw runtime_error(error);
+    return !Interrupted();
+}
+
+size_t ThreadPool::getJobs(int thread) const
+{
+    return _workers[thread]->_jobs;
+}
+
+double ThreadPool::getBusyTime(int thread) const
+{
+    return _workers[thread]->_busy;
+}
+
+double ThreadPool::getElapsedTime() const
+{
+    return Profiler::Now() - _start;
+}
+
+}}
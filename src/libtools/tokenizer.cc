@@ -16,6 +16,7 @@
  */
 
 #include <votca/tools/tokenizer.h>
+#include <string.h>
 
 namespace votca { namespace tools {
 
@@ -53,4 +54,81 @@ int wildcmp(const char *wild, const char *string) {
     return !*wild;
 }
 
+void WildcardMatcher::Compile(const std::string &pattern)
+{
+    _pattern = pattern;
+    _literal_prefix = pattern.substr(0, pattern.find_first_of("*?"));
+    _question = pattern.find('?') != std::string::npos;
+    _segments.clear();
+
+    std::string::size_type first = pattern.find('*');
+    _star = first != std::string::npos;
+    if(!_star) {
+        _prefix = pattern;
+        _suffix.clear();
+        _min_length = pattern.size();
+        return;
+    }
+    std::string::size_type last = pattern.rfind('*');
+    _prefix = pattern.substr(0, first);
+    _suffix = pattern.substr(last + 1);
+    _min_length = _prefix.size() + _suffix.size();
+
+    // split the middle at the stars, consecutive stars give empty parts
+    std::string::size_type start = first + 1;
+    while(start < last) {
+        std::string::size_type end = pattern.find('*', start);
+        if(end > start) {
+            _segments.push_back(pattern.substr(start, end - start));
+            _min_length += end - start;
+        }
+        start = end + 1;
+    }
+}
+
+// names are short, plain loops are faster than memchr/memcmp here
+inline bool WildcardMatcher::Compare(const char *str, const std::string &part) const
+{
+    const char *p = part.data();
+    for(size_t i = 0, n = part.size(); i < n; ++i)
+        if(p[i] != str[i] && p[i] != '?') return false;
+    return true;
+}
+
+inline const char *WildcardMatcher::Find(const char *begin, const char *end, const std::string &part) const
+{
+    if(end - begin < (ptrdiff_t)part.size()) return NULL;
+    const char first = part[0];
+    const bool any = first == '?';
+    for(end -= part.size(); begin <= end; ++begin)
+        if((*begin == first || any) && Compare(begin, part)) return begin;
+    return NULL;
+}
+
+bool WildcardMatcher::Match(const char *str, size_t len) const
+{
+    if(len < _min_length) return false;
+    if(!_star)
+        return len == _prefix.size() && Compare(str, _prefix);
+
+    if(!Compare(str, _prefix)) return false;
+    if(!Compare(str + len - _suffix.size(), _suffix)) return false;
+
+    // the leftmost match of each part leaves most room for the following ones
+    const char *pos = str + _prefix.size();
+    const char *end = str + len - _suffix.size();
+    for(std::vector<std::string>::const_iterator seg = _segments.begin();
+            seg != _segments.end(); ++seg) {
+        pos = Find(pos, end, *seg);
+        if(pos == NULL) return false;
+        pos += seg->size();
+    }
+    return true;
+}
+
+bool WildcardMatcher::Match(const char *str) const
+{
+    return Match(str, strlen(str));
+}
+
 }}
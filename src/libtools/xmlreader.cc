@@ -0,0 +1,306 @@
+/*
+ * Copyright 2009-2013 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <expat.h>
+#include <votca/tools/xmlreader.h>
+#include <votca/tools/compressedstream.h>
+#include <boost/lexical_cast.hpp>
+
+namespace votca { namespace tools {
+
+// size of the blocks read from the input
+static const int XMLREADER_BLOCK = 65536;
+
+XMLReader::XMLReader()
+    : _parser(NULL), _in(NULL), _file(NULL), _pos(0), _count(0),
+    _parse_depth(0), _skip_depth(0), _suspended(false), _finished(true),
+    _skip_whitespace(true)
+{}
+
+XMLReader::XMLReader(const std::string &filename)
+    : _parser(NULL), _in(NULL), _file(NULL), _pos(0), _count(0),
+    _parse_depth(0), _skip_depth(0), _suspended(false), _finished(true),
+    _skip_whitespace(true)
+{
+    Open(filename);
+}
+
+XMLReader::~XMLReader()
+{
+    Close();
+}
+
+void XMLReader::Open(const std::string &filename)
+{
+    Close();
+    _file = new CompressedIFStream(filename);
+    if(_file->fail()) {
+        delete _file;
+        _file = NULL;
+        throw std::runtime_error("Error on open xml file: " + filename);
+    }
+    Init(*_file, filename);
+}
+
+void XMLReader::Open(std::istream &in, const std::string &name)
+{
+    Close();
+    Init(in, name);
+}
+
+void XMLReader::Init(std::istream &in, const std::string &name)
+{
+    XML_Parser parser = XML_ParserCreate(NULL);
+    if (!parser)
+        throw std::runtime_error("Couldn't allocate memory for xml parser");
+    XML_SetUserData(parser, (void*) this);
+    XML_SetElementHandler(parser, StartHndl, EndHndl);
+    XML_SetCharacterDataHandler(parser, CharHndl);
+
+    _parser = parser;
+    _in = &in;
+    _name = name;
+    _pos = _count = 0;
+    _parse_depth = _skip_depth = 0;
+    _suspended = false;
+    _finished = false;
+}
+
+void XMLReader::Close()
+{
+    if(_parser)
+        XML_ParserFree((XML_Parser)_parser);
+    _parser = NULL;
+    delete _file;
+    _file = NULL;
+    _in = NULL;
+    _pos = _count = 0;
+    _finished = true;
+}
+
+XMLReader::EventType XMLReader::Next()
+{
+    if(_parser == NULL)
+        throw std::runtime_error("XMLReader: no input opened");
+
+    if(_count > 0) {
+        if(current()._type == EndDocument)
+            return EndDocument;
+        ++_pos;
+    }
+    if(_pos >= _count)
+        _pos = _count = 0;
+
+    while(true) {
+        // text is complete once the next event arrived
+        while(!_finished && (_pos >= _count
+                || (_events[_pos]._type == Text && _pos + 1 >= _count)))
+            Feed();
+
+        const Event &e = _events[_pos];
+        if(e._type == Text && _skip_whitespace
+                && e._name.find_first_not_of(" \t\r\n") == std::string::npos) {
+            ++_pos;
+            continue;
+        }
+        return e._type;
+    }
+}
+
+bool XMLReader::NextElement()
+{
+    while(true) {
+        EventType type = Next();
+        if(type == StartElement) return true;
+        if(type == EndDocument) return false;
+    }
+}
+
+bool XMLReader::NextChild(int depth)
+{
+    while(true) {
+        EventType type = Next();
+        if(type == StartElement && Depth() == depth + 1) return true;
+        if(type == EndElement && Depth() == depth) return false;
+        if(type == EndDocument) return false;
+    }
+}
+
+void XMLReader::SkipSubtree()
+{
+    if(_count == 0 || Type() != StartElement)
+        throw std::runtime_error("XMLReader: SkipSubtree must be called at a start element");
+    int depth = Depth();
+
+    // the end might be queued already
+    for(size_t i = _pos + 1; i < _count; ++i)
+        if(_events[i]._type == EndElement && _events[i]._depth == depth) {
+            _pos = i;
+            return;
+        }
+
+    // drop everything until the end element is reported
+    _pos = _count = 0;
+    _skip_depth = depth;
+    while(_count == 0) {
+        if(_finished)
+            Error("unexpected end of document");
+        Feed();
+    }
+}
+
+std::string XMLReader::ReadText()
+{
+    if(_count == 0 || Type() != StartElement)
+        throw std::runtime_error("XMLReader: ReadText must be called at a start element");
+    int depth = Depth();
+    std::string text;
+    while(true) {
+        EventType type = Next();
+        if(type == Text)
+            text += Value();
+        else if(type == StartElement)
+            SkipSubtree();
+        else if(type == EndElement && Depth() == depth)
+            break;
+        else if(type == EndDocument)
+            Error("unexpected end of document");
+    }
+    return text;
+}
+
+const std::string *XMLReader::findAttribute(const std::string &name) const
+{
+    const Event &e = current();
+    for(int i = 0; i < e._nattributes; ++i)
+        if(e._attributes[i].first == name)
+            return &e._attributes[i].second;
+    return NULL;
+}
+
+XMLReader::Event &XMLReader::Push(EventType type)
+{
+    if(_count == _events.size())
+        _events.push_back(Event());
+    Event &e = _events[_count++];
+    e._type = type;
+    e._nattributes = 0;
+    e._depth = _parse_depth;
+    e._line = _parser ? XML_GetCurrentLineNumber((XML_Parser)_parser) : 0;
+    return e;
+}
+
+void XMLReader::Feed()
+{
+    XML_Parser parser = (XML_Parser)_parser;
+    XML_Status status;
+
+    if(_suspended) {
+        _suspended = false;
+        status = XML_ResumeParser(parser);
+    }
+    else {
+        void *buffer = XML_GetBuffer(parser, XMLREADER_BLOCK);
+        if(buffer == NULL)
+            throw std::runtime_error("Couldn't allocate memory for xml parser");
+        _in->read((char*)buffer, XMLREADER_BLOCK);
+        int n = _in->gcount();
+        if(_in->bad())
+            Error("read error");
+        status = XML_ParseBuffer(parser, n, n < XMLREADER_BLOCK);
+    }
+
+    if(status == XML_STATUS_ERROR)
+        Error(XML_ErrorString(XML_GetErrorCode(parser)));
+
+    XML_ParsingStatus parsing;
+    XML_GetParsingStatus(parser, &parsing);
+    if(parsing.parsing == XML_SUSPENDED)
+        _suspended = true;
+    else if(parsing.parsing == XML_FINISHED) {
+        _finished = true;
+        Push(EndDocument);
+    }
+}
+
+void XMLReader::Error(const std::string &message)
+{
+    int line = _parser ? XML_GetCurrentLineNumber((XML_Parser)_parser) : 0;
+    throw std::runtime_error(_name + ": Parse error at line "
+        + boost::lexical_cast<std::string>(line) + "\n" + message);
+}
+
+// stop after the current handler, the events queued so far are returned first
+static void suspend(XML_Parser parser)
+{
+    XML_ParsingStatus parsing;
+    XML_GetParsingStatus(parser, &parsing);
+    if(parsing.parsing == XML_PARSING)
+        XML_StopParser(parser, XML_TRUE);
+}
+
+void XMLReader::StartHndl(void *data, const char *el, const char **attr)
+{
+    XMLReader *reader = (XMLReader*)data;
+    ++reader->_parse_depth;
+    if(reader->_skip_depth && reader->_parse_depth > reader->_skip_depth)
+        return;
+
+    Event &e = reader->Push(StartElement);
+    e._name = el;
+    // reuse the attribute strings of earlier events
+    for(int i = 0; attr[i]; i += 2, ++e._nattributes) {
+        if(e._nattributes == (int)e._attributes.size())
+            e._attributes.push_back(std::pair<std::string, std::string>());
+        e._attributes[e._nattributes].first = attr[i];
+        e._attributes[e._nattributes].second = attr[i + 1];
+    }
+    suspend((XML_Parser)reader->_parser);
+}
+
+void XMLReader::EndHndl(void *data, const char *el)
+{
+    XMLReader *reader = (XMLReader*)data;
+    int depth = reader->_parse_depth--;
+    if(reader->_skip_depth) {
+        if(depth > reader->_skip_depth)
+            return;
+        reader->_skip_depth = 0;
+    }
+
+    Event &e = reader->Push(EndElement);
+    e._name = el;
+    e._depth = depth;
+    suspend((XML_Parser)reader->_parser);
+}
+
+void XMLReader::CharHndl(void *data, const char *txt, int len)
+{
+    XMLReader *reader = (XMLReader*)data;
+    if(reader->_skip_depth && reader->_parse_depth >= reader->_skip_depth)
+        return;
+
+    // character data arrive in pieces, merge them into one event
+    if(reader->_count > reader->_pos && reader->_events[reader->_count - 1]._type == Text) {
+        reader->_events[reader->_count - 1]._name.append(txt, len);
+        return;
+    }
+    Event &e = reader->Push(Text);
+    e._name.assign(txt, len);
+}
+
+}}
@@ -25,6 +25,8 @@
 #include <votca/tools/property.h>
 #include <votca/tools/application.h>
 #include <votca/tools/propertyiomanipulator.h>
+#include <votca/tools/memstat.h>
+#include <votca/tools/propertycache.h>
 #include <list>
 
 using namespace std;
@@ -53,6 +55,11 @@ public:
         
      };
     
+    void ResetJob() {
+        format = "XML";
+        level = 1;
+    }
+
     bool EvaluateOptions() {
         CheckRequired("file", "Missing XML file");
         return true;
@@ -68,7 +75,9 @@ public:
         
         try {
 
-        Property p;
+        // cached, in batch mode the file is parsed only once
+        boost::shared_ptr<const Property> pp = PropertyCache::Load(file);
+        const Property &p = *pp;
 
         map<string, PropertyIOManipulator* > _mformat;
         map<string, PropertyIOManipulator* >::iterator it;
@@ -79,7 +88,7 @@ public:
         _mformat["HLP"] = &HLP;
 
 
-        load_property_from_xml(p, file);
+        MemStat::Record("Property " + file, p.MemoryUsage());
 
         it = _mformat.find( format );
         if ( it != _mformat.end() ) {